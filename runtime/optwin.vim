@@ -285,6 +285,12 @@ endif
 call <SID>Header("tags")
 call append("$", "tagbsearch\tuse binary searching in tags files")
 call <SID>BinOptionG("tbs", &tbs)
+if has("tag_binary")
+  call append("$", "tagindex\tindex tags files for faster searching")
+  call <SID>BinOptionG("tgi", &tgi)
+endif
+call append("$", "tagcache\tmaximum memory in Kbyte for caching tags files")
+call append("$", " \tset tca=" . &tca)
 call append("$", "taglength\tnumber of significant characters in a tag name or zero")
 call append("$", " \tset tl=" . &tl)
 call append("$", "tags\tlist of file names to search for tags")
@@ -516,6 +522,10 @@ if has("terminal")
     call <SID>OptionG("twt", &twt)
   endif
   call <SID>OptionL("twsl")
+  if has("timers")
+    call append("$", "termwinupdate\tminimal time between terminal window redraws in msec")
+    call <SID>OptionG("twu", &twu)
+  endif
   if exists("&winptydll")
     call append("$", "winptydll\tname of the winpty dynamic library")
     call <SID>OptionG("winptydll", &winptydll)
@@ -765,6 +775,8 @@ call append("$", "undofile\tautomatically save and restore undo history")
 call <SID>BinOptionG("udf", &udf)
 call append("$", "undodir\tlist of directories for undo files")
 call <SID>OptionG("udir", &udir)
+call append("$", "undomaxmem\tmaximum Kbyte of memory used for undo text in a buffer")
+call append("$", " \tset umm=" . &umm)
 call append("$", "undoreload\tmaximum number lines to save for undo on a buffer reload")
 call append("$", " \tset ur=" . &ur)
 call append("$", "modified\tchanges have been made and not written to a file")
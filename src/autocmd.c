@@ -67,6 +67,9 @@ typedef struct AutoPat
 					// be the first entry.
     char_u	    *pat;		// pattern as typed (NULL when pattern
 					// has been removed)
+    char_u	    *reg_pat;		// regexp pattern, until compiled
+    char_u	    reg_cpo[3];		// 'cpoptions' flags for compiling
+					// "reg_pat", as when it was defined
     regprog_T	    *reg_prog;		// compiled regprog for pattern
     AutoCmd	    *cmds;		// list of commands to do
     int		    group;		// group ID
@@ -261,6 +264,7 @@ static int au_get_grouparg(char_u **argp);
 static int do_autocmd_event(event_T event, char_u *pat, int once, int nested, char_u *cmd, int forceit, int group);
 static int apply_autocmds_group(event_T event, char_u *fname, char_u *fname_io, int force, int group, buf_T *buf, exarg_T *eap);
 static void auto_next_pat(AutoPatCmd *apc, int stop_at_last);
+static int match_autopat(AutoPat *ap, char_u *fname, char_u *sfname, char_u *tail);
 static int au_find_group(char_u *name);
 
 static event_T	last_event;
@@ -431,6 +435,7 @@ au_cleanup(void)
 			last_autopat[(int)event] = (AutoPat *)prev_ap;
 		}
 		*prev_ap = ap->next;
+		vim_free(ap->reg_pat);
 		vim_regfree(ap->reg_prog);
 		vim_free(ap);
 	    }
@@ -1204,22 +1209,35 @@ do_autocmd_event(
 		    return FAIL;
 		}
 
+		ap->reg_pat = NULL;
+		ap->reg_prog = NULL;
 		if (is_buflocal)
-		{
 		    ap->buflocal_nr = buflocal_nr;
-		    ap->reg_prog = NULL;
-		}
 		else
 		{
-		    char_u	*reg_pat;
-
+		    // Compiling the pattern is postponed until an event is
+		    // triggered, most patterns defined at startup are never
+		    // used.  Check it now, so that an invalid pattern is
+		    // rejected here.
 		    ap->buflocal_nr = 0;
-		    reg_pat = file_pat_to_reg_pat(pat, endpat,
+		    ap->reg_pat = file_pat_to_reg_pat(pat, endpat,
 							 &ap->allow_dirs, TRUE);
-		    if (reg_pat != NULL)
-			ap->reg_prog = vim_regcomp(reg_pat, RE_MAGIC);
-		    vim_free(reg_pat);
-		    if (reg_pat == NULL || ap->reg_prog == NULL)
+		    if (ap->reg_pat != NULL
+				&& vim_regcheck(ap->reg_pat, RE_MAGIC) == FAIL)
+			VIM_CLEAR(ap->reg_pat);
+		    if (ap->reg_pat != NULL)
+		    {
+			int	    len = 0;
+
+			// Remember the 'cpoptions' flags that change how the
+			// pattern is compiled.
+			if (vim_strchr(p_cpo, CPO_LITERAL) != NULL)
+			    ap->reg_cpo[len++] = CPO_LITERAL;
+			if (vim_strchr(p_cpo, CPO_BACKSL) != NULL)
+			    ap->reg_cpo[len++] = CPO_BACKSL;
+			ap->reg_cpo[len] = NUL;
+		    }
+		    if (ap->reg_pat == NULL)
 		    {
 			vim_free(ap->pat);
 			vim_free(ap);
@@ -2117,8 +2135,21 @@ apply_autocmds_group(
 	// make sure cursor and topline are valid
 	check_lnums(TRUE);
 
+#ifdef STARTUPTIME
+	if (trace_fd != NULL)
+	{
+	    vim_snprintf((char *)IObuff, IOSIZE, "%s %s",
+			       event_nr2name(event), sfname != NULL ? sfname
+				      : fname != NULL ? fname : (char_u *)"");
+	    trace_begin("autocmd", IObuff);
+	}
+#endif
 	do_cmdline(NULL, getnextac, (void *)&patcmd,
 				     DOCMD_NOWAIT|DOCMD_VERBOSE|DOCMD_REPEAT);
+#ifdef STARTUPTIME
+	if (trace_fd != NULL)
+	    trace_end();
+#endif
 
 	// restore cursor and topline, unless they were changed
 	reset_lnums();
@@ -2260,6 +2291,30 @@ is_autocmd_blocked(void)
 }
 #endif
 
+/*
+ * Return TRUE if file name "fname" matches the pattern of "ap".  The
+ * pattern is compiled when it is used for the first time, with the
+ * 'cpoptions' flags that were set when it was defined.  When this fails the
+ * pattern never matches.
+ */
+    static int
+match_autopat(AutoPat *ap, char_u *fname, char_u *sfname, char_u *tail)
+{
+    if (ap->reg_pat != NULL)
+    {
+	char_u	*save_cpo = p_cpo;
+
+	p_cpo = ap->reg_cpo;
+	ap->reg_prog = vim_regcomp(ap->reg_pat, RE_MAGIC);
+	p_cpo = save_cpo;
+	VIM_CLEAR(ap->reg_pat);
+    }
+    if (ap->reg_prog == NULL)
+	return FALSE;
+    return match_file_pat(NULL, &ap->reg_prog, fname, sfname, tail,
+							      ap->allow_dirs);
+}
+
 /*
  * Find next autocommand pattern that matches.
  */
@@ -2287,8 +2342,7 @@ auto_next_pat(
 	{
 	    // execution-condition
 	    if (ap->buflocal_nr == 0
-		    ? (match_file_pat(NULL, &ap->reg_prog, apc->fname,
-				      apc->sfname, apc->tail, ap->allow_dirs))
+		    ? match_autopat(ap, apc->fname, apc->sfname, apc->tail)
 		    : ap->buflocal_nr == apc->arg_bufnr)
 	    {
 		name = event_nr2name(apc->event);
@@ -2418,8 +2472,7 @@ has_autocmd(event_T event, char_u *sfname, buf_T *buf)
     for (ap = first_autopat[(int)event]; ap != NULL; ap = ap->next)
 	if (ap->pat != NULL && ap->cmds != NULL
 	      && (ap->buflocal_nr == 0
-		? match_file_pat(NULL, &ap->reg_prog,
-					  fname, sfname, tail, ap->allow_dirs)
+		? match_autopat(ap, fname, sfname, tail)
 		: buf != NULL && ap->buflocal_nr == buf->b_fnum
 	   ))
 	{
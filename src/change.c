@@ -461,7 +461,14 @@ changed_common(
 #ifdef FEAT_EVAL
     may_record_change(lnum, col, lnume, xtra);
 #endif
+#ifdef FEAT_SPELL
+    spell_cache_changed(curbuf, lnum, lnume, xtra);
+#endif
+#ifdef FEAT_INS_EXPAND
+    ins_compl_words_changed(curbuf, lnum, lnume, xtra);
+#endif
 #ifdef FEAT_DIFF
+    diff_changed_lines(lnum, lnume, xtra);
     if (curwin->w_p_diff && diff_internal())
 	curtab->tp_diff_update = TRUE;
 #endif
@@ -36,6 +36,8 @@ static int diff_need_update = FALSE; // ex_diffupdate needs to be called
 #define DIFF_HIDDEN_OFF	0x100	// diffoff when hidden
 #define DIFF_INTERNAL	0x200	// use internal xdiff algorithm
 #define ALL_WHITE_DIFF (DIFF_IWHITE | DIFF_IWHITEALL | DIFF_IWHITEEOL)
+// flags that change the line hashes computed by xdiff
+#define DIFF_HASH_FLAGS (DIFF_ICASE | ALL_WHITE_DIFF)
 static int	diff_flags = DIFF_INTERNAL | DIFF_FILLER;
 
 static long diff_algorithm = 0;
@@ -44,6 +46,23 @@ static long diff_algorithm = 0;
 
 static int diff_a_works = MAYBE; /* TRUE when "diff -a" works, FALSE when it
 				    doesn't work, MAYBE when not checked yet */
+#ifdef FEAT_FOLDING
+/*
+ * Result of the last diff_infold() call, valid for lines "infold_lnum_lo" to
+ * "infold_lnum_hi" (exclusive) of buffer "infold_idx" in tab page
+ * "infold_tp".  "infold_dp" is the diff block to continue with for lines
+ * below that.  Avoids going over all diff blocks for every line when
+ * computing folds.  "infold_tp" is NULL when the diff blocks changed.
+ */
+static tabpage_T *infold_tp = NULL;
+static int	infold_idx;
+static long	infold_context;
+static linenr_T	infold_lnum_lo;
+static linenr_T	infold_lnum_hi;
+static int	infold_result;
+static diff_T	*infold_dp;
+#endif
+
 #if defined(MSWIN)
 static int diff_bin_works = MAYBE; /* TRUE when "diff --binary" works, FALSE
 				      when it doesn't work, MAYBE when not
@@ -71,6 +90,7 @@ typedef struct {
 } diffio_T;
 
 static int diff_buf_idx(buf_T *buf);
+static void diff_hash_clear(buf_T *buf);
 static int diff_buf_idx_tp(buf_T *buf, tabpage_T *tp);
 static void diff_mark_adjust_tp(tabpage_T *tp, int idx, linenr_T line1, linenr_T line2, long amount, long amount_after);
 static void diff_check_unchanged(tabpage_T *tp, diff_T *dp);
@@ -78,6 +98,7 @@ static int diff_check_sanity(tabpage_T *tp, diff_T *dp);
 static void diff_redraw(int dofold);
 static int check_external_diff(diffio_T *diffio);
 static int diff_file(diffio_T *diffio);
+static int diff_try_update_incr(void);
 static int diff_equal_entry(diff_T *dp, int idx1, int idx2);
 static int diff_cmp(char_u *s1, char_u *s2);
 #ifdef FEAT_FOLDING
@@ -90,6 +111,12 @@ static int parse_diff_ed(char_u *line, linenr_T *lnum_orig, long *count_orig, li
 static int parse_diff_unified(char_u *line, linenr_T *lnum_orig, long *count_orig, linenr_T *lnum_new, long *count_new);
 static int xdiff_out(void *priv, mmbuffer_t *mb, int nbuf);
 
+#ifdef FEAT_FOLDING
+# define DIFF_INFOLD_INVALIDATE() infold_tp = NULL
+#else
+# define DIFF_INFOLD_INVALIDATE()
+#endif
+
 /*
  * Called when deleting or unloading a buffer: No longer make a diff with it.
  */
@@ -99,6 +126,7 @@ diff_buf_delete(buf_T *buf)
     int		i;
     tabpage_T	*tp;
 
+    diff_hash_clear(buf);
     FOR_ALL_TABPAGES(tp)
     {
 	i = diff_buf_idx_tp(buf, tp);
@@ -106,6 +134,7 @@ diff_buf_delete(buf_T *buf)
 	{
 	    tp->tp_diffbuf[i] = NULL;
 	    tp->tp_diff_invalid = TRUE;
+	    tp->tp_diff_incr = FALSE;
 	    if (tp == curtab)
 		diff_redraw(TRUE);
 	}
@@ -136,7 +165,9 @@ diff_buf_adjust(win_T *win)
 	    {
 		curtab->tp_diffbuf[i] = NULL;
 		curtab->tp_diff_invalid = TRUE;
+		curtab->tp_diff_incr = FALSE;
 		diff_redraw(TRUE);
+		diff_hash_clear(win->w_buffer);
 	    }
 	}
     }
@@ -165,6 +196,7 @@ diff_buf_add(buf_T *buf)
 	{
 	    curtab->tp_diffbuf[i] = buf;
 	    curtab->tp_diff_invalid = TRUE;
+	    curtab->tp_diff_incr = FALSE;
 	    diff_redraw(TRUE);
 	    return;
 	}
@@ -185,6 +217,7 @@ diff_buf_clear(void)
 	{
 	    curtab->tp_diffbuf[i] = NULL;
 	    curtab->tp_diff_invalid = TRUE;
+	    curtab->tp_diff_incr = FALSE;
 	    diff_redraw(TRUE);
 	}
 }
@@ -219,6 +252,76 @@ diff_buf_idx_tp(buf_T *buf, tabpage_T *tp)
     return idx;
 }
 
+/*
+ * Free the line hashes kept for buffer "buf".
+ */
+    static void
+diff_hash_clear(buf_T *buf)
+{
+    VIM_CLEAR(buf->b_diff_hash);
+    buf->b_diff_hash_len = 0;
+}
+
+/*
+ * Get the array with the line hashes for buffer "buf", for the internal diff.
+ * Allocates a new array when there is none or it can't be used.
+ * Returns NULL when out of memory.
+ */
+    static unsigned long *
+diff_hash_get(buf_T *buf)
+{
+    if (buf->b_diff_hash != NULL
+	    && buf->b_diff_hash_len == buf->b_ml.ml_line_count
+	    && buf->b_diff_hash_flags == (diff_flags & DIFF_HASH_FLAGS))
+	return buf->b_diff_hash;
+
+    diff_hash_clear(buf);
+    buf->b_diff_hash = LALLOC_CLEAR_MULT(unsigned long,
+						    buf->b_ml.ml_line_count + 1);
+    if (buf->b_diff_hash != NULL)
+    {
+	buf->b_diff_hash_len = buf->b_ml.ml_line_count;
+	buf->b_diff_hash_flags = diff_flags & DIFF_HASH_FLAGS;
+    }
+    return buf->b_diff_hash;
+}
+
+/*
+ * Update the line hashes of "curbuf" for a change: lines "lnum" to "lnume"
+ * (not including) were changed and "xtra" lines were added.
+ */
+    static void
+diff_hash_changed(linenr_T lnum, linenr_T lnume, long xtra)
+{
+    unsigned long   *ha = curbuf->b_diff_hash;
+    linenr_T	    len = curbuf->b_diff_hash_len;
+
+    if (lnum < 1 || lnume < lnum || lnume > len + 1 || len + xtra < 0)
+    {
+	// Can't tell which lines changed.
+	diff_hash_clear(curbuf);
+	return;
+    }
+    if (xtra > 0)
+    {
+	ha = vim_realloc(ha, (len + xtra + 1) * sizeof(unsigned long));
+	if (ha == NULL)
+	{
+	    diff_hash_clear(curbuf);
+	    return;
+	}
+	curbuf->b_diff_hash = ha;
+    }
+    // Index zero is for line 1.
+    if (xtra != 0)
+	mch_memmove(ha + lnume - 1 + xtra, ha + lnume - 1,
+				     (len - lnume + 1) * sizeof(unsigned long));
+    if (lnume + xtra > lnum)
+	vim_memset(ha + lnum - 1, 0,
+			       (lnume + xtra - lnum) * sizeof(unsigned long));
+    curbuf->b_diff_hash_len = len + xtra;
+}
+
 /*
  * Mark the diff info involving buffer "buf" as invalid, it will be updated
  * when info is requested.
@@ -229,12 +332,14 @@ diff_invalidate(buf_T *buf)
     tabpage_T	*tp;
     int		i;
 
+    diff_hash_clear(buf);
     FOR_ALL_TABPAGES(tp)
     {
 	i = diff_buf_idx_tp(buf, tp);
 	if (i != DB_COUNT)
 	{
 	    tp->tp_diff_invalid = TRUE;
+	    tp->tp_diff_incr = FALSE;
 	    if (tp == curtab)
 		diff_redraw(TRUE);
 	}
@@ -263,6 +368,51 @@ diff_mark_adjust(
     }
 }
 
+/*
+ * Called by changed_common(): lines "lnum" to "lnume" (not including) of
+ * "curbuf" were changed and "xtra" lines were added.  Remember the range of
+ * changed lines, so that the diffs only need to be updated for that part.
+ */
+    void
+diff_changed_lines(linenr_T lnum, linenr_T lnume, long xtra)
+{
+    int		idx;
+    tabpage_T	*tp;
+    linenr_T	top;
+    linenr_T	bot;
+
+    if (curbuf->b_diff_hash != NULL)
+	diff_hash_changed(lnum, lnume, xtra);
+
+    FOR_ALL_TABPAGES(tp)
+    {
+	idx = diff_buf_idx_tp(curbuf, tp);
+	if (idx == DB_COUNT || !tp->tp_diff_incr)
+	    continue;
+
+	// Line numbers are after the change.  When lines were deleted the
+	// range is empty, "bot" is then "top" - 1.
+	top = lnum;
+	bot = lnume - 1 + xtra;
+	if (bot < top - 1)
+	    bot = top - 1;
+	if (tp->tp_diff_top[idx] != 0)
+	{
+	    if (tp->tp_diff_top[idx] < top)
+		top = tp->tp_diff_top[idx];
+	    if (tp->tp_diff_bot[idx] >= lnume)
+	    {
+		if (tp->tp_diff_bot[idx] + xtra > bot)
+		    bot = tp->tp_diff_bot[idx] + xtra;
+	    }
+	    else if (tp->tp_diff_bot[idx] > bot)
+		bot = tp->tp_diff_bot[idx];
+	}
+	tp->tp_diff_top[idx] = top;
+	tp->tp_diff_bot[idx] = bot;
+    }
+}
+
 /*
  * Update line numbers in tab page "tp" for "curbuf" with index "idx".
  * This attempts to update the changes as much as possible:
@@ -289,6 +439,7 @@ diff_mark_adjust_tp(
     linenr_T	lnum_deleted = line1;	/* lnum of remaining deletion */
     int		check_unchanged;
 
+    DIFF_INFOLD_INVALIDATE();
     if (diff_internal())
     {
 	// Will update diffs before redrawing.  Set _invalid to update the
@@ -696,11 +847,11 @@ clear_diffout(diffout_T *dout)
 }
 
 /*
- * Write buffer "buf" to a memory buffer.
+ * Write lines "start" to "end" of buffer "buf" to a memory buffer.
  * Return FAIL for failure.
  */
     static int
-diff_write_buffer(buf_T *buf, diffin_T *din)
+diff_write_buffer(buf_T *buf, diffin_T *din, linenr_T start, linenr_T end)
 {
     linenr_T	lnum;
     char_u	*s;
@@ -708,9 +859,9 @@ diff_write_buffer(buf_T *buf, diffin_T *din)
     char_u	*ptr;
 
     // xdiff requires one big block of memory with all the text.
-    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+    for (lnum = start; lnum <= end; ++lnum)
 	len += (long)STRLEN(ml_get_buf(buf, lnum, FALSE)) + 1;
-    ptr = alloc(len);
+    ptr = alloc(len == 0 ? 1 : len);
     if (ptr == NULL)
     {
 	// Allocating memory failed.  This can happen, because we try to read
@@ -728,9 +879,14 @@ diff_write_buffer(buf_T *buf, diffin_T *din)
     }
     din->din_mmfile.ptr = (char *)ptr;
     din->din_mmfile.size = len;
+    // Line hashes are kept with the buffer, so that only the hashes of
+    // changed lines are computed for the next diff.
+    din->din_mmfile.ha = diff_hash_get(buf);
+    if (din->din_mmfile.ha != NULL)
+	din->din_mmfile.ha += start - 1;
 
     len = 0;
-    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+    for (lnum = start; lnum <= end; ++lnum)
     {
 	for (s = ml_get_buf(buf, lnum, FALSE); *s != NUL; )
 	{
@@ -772,7 +928,7 @@ diff_write(buf_T *buf, diffin_T *din)
     char_u	*save_ff;
 
     if (din->din_fname == NULL)
-	return diff_write_buffer(buf, din);
+	return diff_write_buffer(buf, din, 1, buf->b_ml.ml_line_count);
 
     // Always use 'fileformat' set to "unix".
     save_ff = buf->b_p_ff;
@@ -909,9 +1065,18 @@ ex_diffupdate(exarg_T *eap)	// "eap" can be NULL
 	return;
     }
 
+    // When only some lines changed, update the diffs for those lines.
+    if (eap == NULL && diff_try_update_incr() == OK)
+    {
+	curwin->w_valid_cursor.lnum = 0;
+	goto theend;
+    }
+
     // Delete all diffblocks.
     diff_clear(curtab);
     curtab->tp_diff_invalid = FALSE;
+    curtab->tp_diff_incr = TRUE;
+    vim_memset(curtab->tp_diff_top, 0, sizeof(curtab->tp_diff_top));
 
     // Use the first buffer as the original text.
     for (idx_orig = 0; idx_orig < DB_COUNT; ++idx_orig)
@@ -1092,6 +1257,187 @@ diff_file_internal(diffio_T *diffio)
     return OK;
 }
 
+/*
+ * Update the diffs for the lines that changed since the last update, keeping
+ * the diff blocks for the rest.  Only the lines between the nearest diff
+ * blocks that are not affected by the changes are compared again.
+ * Only works for two buffers with the internal diff.
+ * Return FAIL when this is not possible, the diffs must be updated
+ * completely then.
+ */
+    static int
+diff_try_update_incr(void)
+{
+    int		idx[2];
+    buf_T	*buf[2];
+    linenr_T	top[2];
+    linenr_T	bot[2];
+    linenr_T	gap_start[2];
+    linenr_T	gap_end[2];
+    linenr_T	start[2];
+    linenr_T	end[2];
+    long	skip_top = MAXLNUM;
+    long	skip_bot = MAXLNUM;
+    diff_T	*dprev = NULL;
+    diff_T	*dlast;
+    diff_T	*dnext;
+    diff_T	*dp;
+    linenr_T	lnum_orig, lnum_new;
+    long	count_orig, count_new;
+    diffio_T	dio;
+    int		i;
+    int		n;
+    int		ret = FAIL;
+
+    if (!curtab->tp_diff_incr || !diff_internal() || diff_internal_failed())
+	return FAIL;
+
+    // Need exactly two loaded buffers.
+    n = 0;
+    for (i = 0; i < DB_COUNT; ++i)
+	if (curtab->tp_diffbuf[i] != NULL)
+	{
+	    if (n == 2 || curtab->tp_diffbuf[i]->b_ml.ml_mfp == NULL)
+		return FAIL;
+	    idx[n] = i;
+	    buf[n++] = curtab->tp_diffbuf[i];
+	}
+    if (n != 2)
+	return FAIL;
+
+    for (i = 0; i < 2; ++i)
+    {
+	top[i] = curtab->tp_diff_top[idx[i]];
+	bot[i] = curtab->tp_diff_bot[idx[i]];
+	if (top[i] != 0)
+	{
+	    if (bot[i] > buf[i]->b_ml.ml_line_count)
+		bot[i] = buf[i]->b_ml.ml_line_count;
+	    if (top[i] > bot[i] + 1)
+		top[i] = bot[i] + 1;
+	}
+    }
+    if (top[0] == 0 && top[1] == 0)
+	goto done;	// nothing changed
+
+    // Find the last diff block that ends at least one line above the
+    // changed lines.
+    for (dp = curtab->tp_first_diff; dp != NULL; dp = dp->df_next)
+    {
+	for (i = 0; i < 2; ++i)
+	    if (top[i] != 0
+		     && dp->df_lnum[idx[i]] + dp->df_count[idx[i]] >= top[i])
+		break;
+	if (i < 2)
+	    break;
+	dprev = dp;
+    }
+
+    // Find the first diff block that starts at least one line below the
+    // changed lines.
+    dlast = dprev;
+    for (dnext = dp; dnext != NULL; dnext = dnext->df_next)
+    {
+	for (i = 0; i < 2; ++i)
+	    if (top[i] != 0 && dnext->df_lnum[idx[i]] <= bot[i] + 1)
+		break;
+	if (i == 2)
+	    break;
+	dlast = dnext;
+    }
+
+    // The lines after "dprev" and before "dnext" are equal in both buffers,
+    // except the changed ones.  Skip over the lines above and below the
+    // changes that are equal.
+    for (i = 0; i < 2; ++i)
+    {
+	gap_start[i] = dprev == NULL ? 1
+			 : dprev->df_lnum[idx[i]] + dprev->df_count[idx[i]];
+	gap_end[i] = dnext == NULL ? buf[i]->b_ml.ml_line_count
+						: dnext->df_lnum[idx[i]] - 1;
+	if (top[i] != 0)
+	{
+	    if (top[i] - gap_start[i] < skip_top)
+		skip_top = top[i] - gap_start[i];
+	    if (gap_end[i] - bot[i] < skip_bot)
+		skip_bot = gap_end[i] - bot[i];
+	}
+    }
+    n = (dp == NULL ? buf[0]->b_ml.ml_line_count + 1 : dp->df_lnum[idx[0]])
+								- gap_start[0];
+    if (n != (dp == NULL ? buf[1]->b_ml.ml_line_count + 1
+					 : dp->df_lnum[idx[1]]) - gap_start[1])
+	return FAIL;	// line numbers are out of sync
+    if (n < skip_top)
+	skip_top = n;
+    for (i = 0; i < 2; ++i)
+	end[i] = dlast == NULL ? 0 : dlast->df_lnum[idx[i]]
+						    + dlast->df_count[idx[i]] - 1;
+    n = gap_end[0] - end[0];
+    if (n != gap_end[1] - end[1])
+	return FAIL;	// line numbers are out of sync
+    if (n < skip_bot)
+	skip_bot = n;
+    if (skip_top < 0 || skip_bot < 0)
+	return FAIL;
+
+    for (i = 0; i < 2; ++i)
+    {
+	start[i] = gap_start[i] + skip_top;
+	end[i] = gap_end[i] - skip_bot;
+	if (start[i] > end[i] + 1)
+	    return FAIL;
+    }
+
+    vim_memset(&dio, 0, sizeof(dio));
+    dio.dio_internal = TRUE;
+    ga_init2(&dio.dio_diff.dout_ga, sizeof(char *), 100);
+    if (diff_write_buffer(buf[0], &dio.dio_orig, start[0], end[0]) == FAIL
+	    || diff_write_buffer(buf[1], &dio.dio_new, start[1], end[1]) == FAIL
+	    || diff_file_internal(&dio) == FAIL)
+	goto theend;
+
+    // Replace the diff blocks for the changed lines with the new ones.
+    while ((dp = dprev == NULL ? curtab->tp_first_diff : dprev->df_next)
+								     != dnext)
+    {
+	if (dprev == NULL)
+	    curtab->tp_first_diff = dp->df_next;
+	else
+	    dprev->df_next = dp->df_next;
+	vim_free(dp);
+    }
+    for (n = 0; n < dio.dio_diff.dout_ga.ga_len; ++n)
+    {
+	if (parse_diff_unified(((char_u **)dio.dio_diff.dout_ga.ga_data)[n],
+		       &lnum_orig, &count_orig, &lnum_new, &count_new) == FAIL)
+	    continue;
+	dp = diff_alloc_new(curtab, dprev, dnext);
+	if (dp == NULL)
+	    goto theend;
+	dp->df_lnum[idx[0]] = lnum_orig + start[0] - 1;
+	dp->df_count[idx[0]] = count_orig;
+	dp->df_lnum[idx[1]] = lnum_new + start[1] - 1;
+	dp->df_count[idx[1]] = count_new;
+	dprev = dp;
+    }
+
+done:
+    curtab->tp_diff_invalid = FALSE;
+    vim_memset(curtab->tp_diff_top, 0, sizeof(curtab->tp_diff_top));
+    DIFF_INFOLD_INVALIDATE();
+    ret = OK;
+
+theend:
+    if (top[0] != 0 || top[1] != 0)
+    {
+	clear_diffin(&dio.dio_orig);
+	clear_diffin(&dio.dio_new);
+	clear_diffout(&dio.dio_diff);
+    }
+    return ret;
+}
+
 /*
  * Make a diff between files "tmp_orig" and "tmp_new", results in "tmp_diff".
  * return OK or FAIL;
@@ -1760,6 +2106,7 @@ diff_read(
     }
 
 done:
+    DIFF_INFOLD_INVALIDATE();
     if (fd != NULL)
 	fclose(fd);
 }
@@ -1793,6 +2140,7 @@ diff_clear(tabpage_T *tp)
 {
     diff_T	*p, *next_p;
 
+    DIFF_INFOLD_INVALIDATE();
     for (p = tp->tp_first_diff; p != NULL; p = next_p)
     {
 	next_p = p->df_next;
@@ -2274,7 +2622,10 @@ diffopt_changed(void)
     // update the diff.
     if (diff_flags != diff_flags_new || diff_algorithm != diff_algorithm_new)
 	FOR_ALL_TABPAGES(tp)
+	{
 	    tp->tp_diff_invalid = TRUE;
+	    tp->tp_diff_incr = FALSE;
+	}
 
     diff_flags = diff_flags_new;
     diff_context = diff_context_new == 0 ? 1 : diff_context_new;
@@ -2454,6 +2805,8 @@ diff_infold(win_T *wp, linenr_T lnum)
     int		idx = -1;
     int		other = FALSE;
     diff_T	*dp;
+    linenr_T	lo = 1;
+    linenr_T	end;
 
     /* Return if 'diff' isn't set. */
     if (!wp->w_p_diff)
@@ -2478,15 +2831,52 @@ diff_infold(win_T *wp, linenr_T lnum)
     if (curtab->tp_first_diff == NULL)
 	return TRUE;
 
-    for (dp = curtab->tp_first_diff; dp != NULL; dp = dp->df_next)
+    dp = curtab->tp_first_diff;
+    if (infold_tp == curtab && infold_idx == idx
+					   && infold_context == diff_context)
+    {
+	if (lnum >= infold_lnum_lo && lnum < infold_lnum_hi)
+	    return infold_result;
+	if (lnum >= infold_lnum_hi)
+	{
+	    /* Continue where the previous call stopped. */
+	    dp = infold_dp;
+	    lo = infold_lnum_hi;
+	}
+    }
+    infold_tp = curtab;
+    infold_idx = idx;
+    infold_context = diff_context;
+
+    for ( ; dp != NULL; dp = dp->df_next)
     {
 	/* If this change is below the line there can't be any further match. */
 	if (dp->df_lnum[idx] - diff_context > lnum)
-	    break;
+	{
+	    infold_lnum_lo = lo;
+	    infold_lnum_hi = dp->df_lnum[idx] - diff_context;
+	    infold_result = TRUE;
+	    infold_dp = dp;
+	    return TRUE;
+	}
+	end = dp->df_lnum[idx] + dp->df_count[idx] + diff_context;
 	/* If this change ends before the line we have a match. */
-	if (dp->df_lnum[idx] + dp->df_count[idx] + diff_context > lnum)
+	if (end > lnum)
+	{
+	    infold_lnum_lo = lo > dp->df_lnum[idx] - diff_context
+				     ? lo : dp->df_lnum[idx] - diff_context;
+	    infold_lnum_hi = end;
+	    infold_result = FALSE;
+	    infold_dp = dp->df_next;
 	    return FALSE;
+	}
+	if (end > lo)
+	    lo = end;
     }
+    infold_lnum_lo = lo;
+    infold_lnum_hi = MAXLNUM;
+    infold_result = TRUE;
+    infold_dp = NULL;
     return TRUE;
 }
 #endif
@@ -2780,6 +3170,7 @@ ex_diffgetput(exarg_T *eap)
 			dprev->df_next = dp;
 		}
 	    }
+	    DIFF_INFOLD_INVALIDATE();
 
 	    /* Adjust marks.  This will change the following entries! */
 	    if (added != 0)
@@ -2808,6 +3199,7 @@ ex_diffgetput(exarg_T *eap)
 	    else
 		/* mark_adjust() may have changed the count in a wrong way */
 		dp->df_count[idx_to] = new_count;
+	    DIFF_INFOLD_INVALIDATE();
 
 	    /* When changing the current buffer, keep track of line numbers */
 	    if (idx_cur == idx_to)
@@ -606,6 +606,10 @@ edit(
 	    dont_sync_undo = TRUE;
 	else
 	    dont_sync_undo = FALSE;
+#ifdef FEAT_INS_EXPAND
+	/* Find more completion matches until a key is typed. */
+	ins_compl_search_more();
+#endif
 	if (cmdchar == K_PS)
 	    /* Got here from normal mode when bracketed paste started. */
 	    c = K_PS;
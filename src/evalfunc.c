@@ -437,6 +437,7 @@ static void f_systemlist(typval_T *argvars, typval_T *rettv);
 static void f_tabpagebuflist(typval_T *argvars, typval_T *rettv);
 static void f_tabpagenr(typval_T *argvars, typval_T *rettv);
 static void f_tabpagewinnr(typval_T *argvars, typval_T *rettv);
+static void f_tagcacheinfo(typval_T *argvars, typval_T *rettv);
 static void f_taglist(typval_T *argvars, typval_T *rettv);
 static void f_tagfiles(typval_T *argvars, typval_T *rettv);
 static void f_tempname(typval_T *argvars, typval_T *rettv);
@@ -840,6 +841,7 @@ static struct fst
 #endif
 #ifdef FEAT_TEXT_PROP
     {"prop_add",	3, 3, f_prop_add},
+    {"prop_add_list",	2, 2, f_prop_add_list},
     {"prop_clear",	1, 3, f_prop_clear},
     {"prop_list",	1, 2, f_prop_list},
     {"prop_remove",	1, 3, f_prop_remove},
@@ -979,6 +981,7 @@ static struct fst
     {"tabpagebuflist",	0, 1, f_tabpagebuflist},
     {"tabpagenr",	0, 1, f_tabpagenr},
     {"tabpagewinnr",	1, 2, f_tabpagewinnr},
+    {"tagcacheinfo",	0, 0, f_tagcacheinfo},
     {"tagfiles",	0, 0, f_tagfiles},
     {"taglist",		1, 2, f_taglist},
 #ifdef FEAT_FLOAT
@@ -14226,6 +14229,16 @@ f_tabpagewinnr(typval_T *argvars UNUSED, typval_T *rettv)
     rettv->vval.v_number = nr;
 }
 
+/*
+ * "tagcacheinfo()" function
+ */
+    static void
+f_tagcacheinfo(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    if (rettv_list_alloc(rettv) == OK)
+	get_tagcache_info(rettv->vval.v_list);
+}
+
 /*
  * "tagfiles()" function
  */
@@ -1884,6 +1884,168 @@ viminfo_error(char *errnum, char *message, char_u *line)
     return FALSE;
 }
 
+#ifndef BACKSLASH_IN_FILENAME
+/*
+ * Index of the marks section of the viminfo file.  For each file name the
+ * offset of its "> fname" line is stored, so that the marks of a buffer can
+ * be read without going through the whole file each time a buffer is
+ * loaded.  Only valid while the viminfo file does not change.
+ * In a hashtable item "hi_key" points to "vm_name" in a vimark_T.
+ */
+typedef struct
+{
+    off_T	vm_offset;	// offset of the "> fname" line
+    char_u	vm_name[1];	// file name, actually longer
+} vimark_T;
+
+#define HIKEY2VM(p)   ((vimark_T *)((p) - offsetof(vimark_T, vm_name)))
+#define HI2VM(hi)      HIKEY2VM((hi)->hi_key)
+
+static hashtab_T *vimarks_ht = NULL;	// NULL when there is no index
+static char_u	*vimarks_fname = NULL;	// viminfo file of the index
+static stat_T	vimarks_st;		// stat() of the viminfo file
+static int	vimarks_valid;		// FALSE when the file may have changed
+					// after indexing it
+#endif
+
+    void
+free_viminfo_marks_index(void)
+{
+#ifndef BACKSLASH_IN_FILENAME
+    int		todo;
+    hashitem_T	*hi;
+
+    VIM_CLEAR(vimarks_fname);
+    if (vimarks_ht == NULL)
+	return;
+    todo = (int)vimarks_ht->ht_used;
+    for (hi = vimarks_ht->ht_array; todo > 0; ++hi)
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    --todo;
+	    vim_free(HI2VM(hi));
+	}
+    hash_clear(vimarks_ht);
+    VIM_CLEAR(vimarks_ht);
+#endif
+}
+
+#ifndef BACKSLASH_IN_FILENAME
+
+/*
+ * Build the index of the marks section of the viminfo file read with "virp".
+ */
+    static void
+index_viminfo_marks(vir_T *virp)
+{
+    off_T	offset = 0;
+    int		eof;
+    char_u	*str;
+    char_u	*p;
+    hash_T	hash;
+    hashitem_T	*hi;
+    vimark_T	*vm;
+
+    vimarks_ht = ALLOC_ONE(hashtab_T);
+    if (vimarks_ht == NULL)
+	return;
+    hash_init(vimarks_ht);
+
+    for (;;)
+    {
+	offset = vim_ftell(virp->vir_fd);
+	if ((eof = viminfo_readline(virp)))
+	    break;
+	if (virp->vir_line[0] != '>')
+	    continue;
+
+	// Get the file name like copy_viminfo_marks() does.
+	str = skipwhite(virp->vir_line + 1);
+	str = viminfo_readstring(virp, (int)(str - virp->vir_line), FALSE);
+	if (str == NULL)
+	    continue;
+	p = str + STRLEN(str);
+	while (p != str && (*p == NUL || vim_isspace(*p)))
+	    p--;
+	if (*p)
+	    p++;
+	*p = NUL;
+
+	// The first entry for a file is used.
+	hash = hash_hash(str);
+	hi = hash_lookup(vimarks_ht, str, hash);
+	if (HASHITEM_EMPTY(hi)
+		&& (vm = (vimark_T *)alloc(sizeof(vimark_T) + STRLEN(str)))
+								      != NULL)
+	{
+	    vm->vm_offset = offset;
+	    STRCPY(vm->vm_name, str);
+	    hash_add_item(vimarks_ht, hi, vm->vm_name, hash);
+	}
+	vim_free(str);
+    }
+}
+
+/*
+ * Read the marks for the current buffer from viminfo file "fp", using the
+ * index of the marks section.  The index is created when needed.
+ * Returns FAIL when the index can't be used.
+ */
+    static int
+read_viminfo_marks_indexed(FILE *fp, char_u *fname)
+{
+    stat_T	st;
+    vir_T	vir;
+    char_u	*name;
+    hashitem_T	*hi;
+
+    if (p_fic || curbuf->b_ffname == NULL
+				    || mch_fstat(fileno(fp), &st) < 0)
+	return FAIL;
+
+    if ((vir.vir_line = alloc(LSIZE)) == NULL)
+	return FAIL;
+    vir.vir_fd = fp;
+    vir.vir_conv.vc_type = CONV_NONE;
+    ga_init2(&vir.vir_barlines, (int)sizeof(char_u *), 100);
+    vir.vir_version = -1;
+
+    if (vimarks_ht == NULL || vimarks_fname == NULL || !vimarks_valid
+	    || STRCMP(vimarks_fname, fname) != 0
+	    || vimarks_st.st_dev != st.st_dev
+	    || vimarks_st.st_ino != st.st_ino
+	    || vimarks_st.st_size != st.st_size
+	    || vimarks_st.st_mtime != st.st_mtime)
+    {
+	free_viminfo_marks_index();
+	index_viminfo_marks(&vir);
+	if (vimarks_ht == NULL)
+	{
+	    vim_free(vir.vir_line);
+	    return FAIL;
+	}
+	vimarks_fname = vim_strsave(fname);
+	vimarks_st = st;
+	// The time stamp has a resolution of a second, a change in the same
+	// second would go unnoticed.  Build the index again next time.
+	vimarks_valid = st.st_mtime < vim_time();
+    }
+
+    name = home_replace_save(NULL, curbuf->b_ffname);
+    if (name != NULL)
+    {
+	hi = hash_find(vimarks_ht, name);
+	if (!HASHITEM_EMPTY(hi)
+		&& vim_fseek(fp, HI2VM(hi)->vm_offset, SEEK_SET) == 0
+		&& !viminfo_readline(&vir))
+	    copy_viminfo_marks(&vir, NULL, NULL, FALSE, VIF_WANT_MARKS);
+	vim_free(name);
+    }
+    vim_free(vir.vir_line);
+    return OK;
+}
+#endif
+
 /*
  * read_viminfo() -- Read the viminfo file.  Registers etc. which are already
  * set are not over-written unless "flags" includes VIF_FORCEIT. -- webb
@@ -1916,13 +2078,22 @@ read_viminfo(
 	verbose_leave();
     }
 
-    vim_free(fname);
     if (fp == NULL)
+    {
+	vim_free(fname);
 	return FAIL;
+    }
 
     viminfo_errcnt = 0;
-    do_viminfo(fp, NULL, flags);
+#ifndef BACKSLASH_IN_FILENAME
+    // Only reading the marks for the current buffer, happens every time a
+    // buffer is loaded: use the index.
+    if (flags != VIF_WANT_MARKS
+			       || read_viminfo_marks_indexed(fp, fname) == FAIL)
+#endif
+	do_viminfo(fp, NULL, flags);
 
+    vim_free(fname);
     fclose(fp);
     return OK;
 }
@@ -4838,6 +5009,65 @@ typedef struct {
     int	do_ic;		/* ignore case flag */
 } subflags_T;
 
+/*
+ * Lines changed by ":s" that have not been put in the buffer yet.
+ */
+typedef struct {
+    linenr_T	sb_lnum;	/* line number of the first line */
+    garray_T	sb_lines;	/* allocated text of the lines */
+} subbatch_T;
+
+#define SUB_BATCH_MAX	1000	/* max number of lines in a subbatch_T */
+
+/*
+ * Put the lines in "sb" in the buffer, after saving them for undo.
+ * Returns FAIL when they could not be saved, the lines are dropped then.
+ */
+    static int
+sub_batch_flush(subbatch_T *sb)
+{
+    linenr_T	bot = sb->sb_lnum + sb->sb_lines.ga_len;
+
+    if (sb->sb_lines.ga_len == 0)
+	return OK;
+    if (u_savecommon(sb->sb_lnum - 1, bot, bot, FALSE) == FAIL)
+    {
+	ga_clear_strings(&sb->sb_lines);
+	return FAIL;
+    }
+    ml_replace_lines(sb->sb_lnum, (long)sb->sb_lines.ga_len,
+					      (char_u **)sb->sb_lines.ga_data);
+    sb->sb_lines.ga_len = 0;
+    return OK;
+}
+
+/*
+ * Add a copy of "line" as the new text of line "lnum" to "sb".  When it
+ * does not follow the lines in "sb" these are put in the buffer first.
+ * Returns FAIL when that failed or when out of memory.
+ */
+    static int
+sub_batch_add(subbatch_T *sb, linenr_T lnum, char_u *line)
+{
+    char_u	*p;
+
+    if (sb->sb_lines.ga_len > 0
+	    && (lnum != sb->sb_lnum + sb->sb_lines.ga_len
+		|| sb->sb_lines.ga_len >= SUB_BATCH_MAX)
+	    && sub_batch_flush(sb) == FAIL)
+	return FAIL;
+    p = vim_strsave(line);
+    if (p == NULL || ga_grow(&sb->sb_lines, 1) == FAIL)
+    {
+	vim_free(p);
+	return FAIL;
+    }
+    if (sb->sb_lines.ga_len == 0)
+	sb->sb_lnum = lnum;
+    ((char_u **)sb->sb_lines.ga_data)[sb->sb_lines.ga_len++] = p;
+    return OK;
+}
+
 /* do_sub()
  *
  * Perform a substitution from line eap->line1 to line eap->line2 using the
@@ -4879,6 +5109,8 @@ do_sub(exarg_T *eap)
     int		endcolumn = FALSE;	/* cursor in last column when done */
     pos_T	old_cursor = curwin->w_cursor;
     int		start_nsubs;
+    int		do_batch;		/* collect lines in sub_batch */
+    subbatch_T	sub_batch;
 #ifdef FEAT_EVAL
     int		save_ma = 0;
 #endif
@@ -5160,6 +5392,20 @@ do_sub(exarg_T *eap)
     if (!(sub[0] == '\\' && sub[1] == '='))
 	sub = regtilde(sub, p_magic);
 
+    /*
+     * When nothing looks at the changed lines while substituting, collect
+     * them and put them in the buffer together.  This is a lot faster when
+     * changing many lines.
+     */
+    do_batch = !subflags.do_ask && !subflags.do_count
+	    && !(sub[0] == '\\' && sub[1] == '=')
+	    && !re_multiline(regmatch.regprog)
+#ifdef FEAT_TEXT_PROP
+	    && !curbuf->b_has_textprop
+#endif
+	    ;
+    ga_init2(&sub_batch.sb_lines, (int)sizeof(char_u *), 100);
+
     /*
      * Check for a match on each line.
      */
@@ -5731,7 +5977,8 @@ do_sub(exarg_T *eap)
 		    }
 		    else if (*p1 == CAR)
 		    {
-			if (u_inssub(lnum) == OK)   // prepare for undo
+			if (sub_batch_flush(&sub_batch) == OK
+				&& u_inssub(lnum) == OK)   // prepare for undo
 			{
 			    colnr_T	plen = (colnr_T)(p1 - new_start + 1);
 
@@ -5815,9 +6062,18 @@ skip:
 			prev_matchcol = (colnr_T)STRLEN(sub_firstline)
 							      - prev_matchcol;
 
-			if (u_savesub(lnum) != OK)
-			    break;
-			ml_replace(lnum, new_start, TRUE);
+			if (do_batch)
+			{
+			    if (sub_batch_add(&sub_batch, lnum, new_start)
+								       == FAIL)
+				break;
+			}
+			else
+			{
+			    if (u_savesub(lnum) != OK)
+				break;
+			    ml_replace(lnum, new_start, TRUE);
+			}
 
 			if (nmatch_tl > 0)
 			{
@@ -5891,6 +6147,9 @@ skip:
 	line_breakcheck();
     }
 
+    /* Put the collected lines in the buffer. */
+    (void)sub_batch_flush(&sub_batch);
+
     if (first_line != 0)
     {
 	/* Need to subtract the number of added lines from "last_line" to get
@@ -5902,6 +6161,7 @@ skip:
 
 outofmem:
     vim_free(sub_firstline); /* may have to free allocated copy of the line */
+    ga_clear_strings(&sub_batch.sb_lines);
 
     /* ":s/pat//n" doesn't move the cursor */
     if (subflags.do_count)
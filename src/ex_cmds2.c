@@ -461,6 +461,10 @@ check_due_timer(void)
     /* Some terminal windows may need their buffer updated. */
     next_due = term_check_timers(next_due, &now);
 #endif
+#ifdef FEAT_FOLDING
+    /* Folds that were postponed are computed a bit at a time. */
+    next_due = foldUpdateIdle(next_due);
+#endif
 
     return current_id != last_timer_id ? 1 : next_due;
 }
@@ -2454,6 +2458,237 @@ source_callback(char_u *fname, void *cookie UNUSED)
     (void)do_source(fname, FALSE, DOSO_NONE);
 }
 
+#if defined(UNIX) && !defined(VMS) && !defined(MACOS_CONVERT)
+# define USE_RTP_DIRS
+#endif
+
+#ifdef USE_RTP_DIRS
+/*
+ * Index of the directories used in 'runtimepath' and 'packpath' lookups.
+ * Each directory is read once and the names are kept until the modification
+ * time of the directory changes.  Looking for "syntax/c_*.vim" then only
+ * needs a stat() of the directory instead of reading it.
+ * In a hashtable item "hi_key" points to "rd_path" in a rtpdir_T.
+ */
+typedef struct
+{
+    time_t	rd_mtime;	// modification time of the directory
+    int		rd_valid;	// FALSE when the directory may have changed
+				// after reading it
+    garray_T	rd_names;	// names in the directory
+    char_u	rd_path[1];	// directory name, actually longer
+} rtpdir_T;
+
+#define HIKEY2RD(p)   ((rtpdir_T *)((p) - offsetof(rtpdir_T, rd_path)))
+#define HI2RD(hi)      HIKEY2RD((hi)->hi_key)
+
+static hashtab_T *rtp_dirs = NULL;
+
+/*
+ * Get the index entry for directory "dir".  Reads the directory when it was
+ * not read before or it has changed.
+ * Returns NULL when the directory does not exist or can't be read.
+ */
+    static rtpdir_T *
+rtp_dir_get(char_u *dir)
+{
+    stat_T	st;
+    hash_T	hash;
+    hashitem_T	*hi;
+    rtpdir_T	*rd = NULL;
+    DIR		*dirp;
+    struct dirent *dp;
+
+    if (mch_stat((char *)dir, &st) < 0 || !S_ISDIR(st.st_mode))
+	return NULL;
+
+    if (rtp_dirs == NULL)
+    {
+	rtp_dirs = ALLOC_ONE(hashtab_T);
+	if (rtp_dirs == NULL)
+	    return NULL;
+	hash_init(rtp_dirs);
+    }
+    hash = hash_hash(dir);
+    hi = hash_lookup(rtp_dirs, dir, hash);
+    if (!HASHITEM_EMPTY(hi))
+    {
+	rd = HI2RD(hi);
+	if (rd->rd_valid && rd->rd_mtime == st.st_mtime)
+	    return rd;
+	ga_clear_strings(&rd->rd_names);
+    }
+
+    dirp = opendir((char *)dir);
+    if (dirp == NULL)
+	return NULL;
+    if (rd == NULL)
+    {
+	rd = (rtpdir_T *)alloc(sizeof(rtpdir_T) + STRLEN(dir));
+	if (rd == NULL)
+	{
+	    closedir(dirp);
+	    return NULL;
+	}
+	STRCPY(rd->rd_path, dir);
+	hash_add_item(rtp_dirs, hi, rd->rd_path, hash);
+    }
+    ga_init2(&rd->rd_names, (int)sizeof(char_u *), 20);
+    while ((dp = readdir(dirp)) != NULL)
+    {
+	if (ga_grow(&rd->rd_names, 1) == FAIL)
+	    break;
+	((char_u **)rd->rd_names.ga_data)[rd->rd_names.ga_len] =
+					     vim_strsave((char_u *)dp->d_name);
+	if (((char_u **)rd->rd_names.ga_data)[rd->rd_names.ga_len] == NULL)
+	    break;
+	++rd->rd_names.ga_len;
+    }
+    closedir(dirp);
+
+    rd->rd_mtime = st.st_mtime;
+    // The time stamp has a resolution of a second, a change in the same
+    // second would go unnoticed.  Read the directory again next time.
+    rd->rd_valid = st.st_mtime < vim_time();
+    return rd;
+}
+
+    static int
+rtp_pathcmp(const void *a, const void *b)
+{
+    return pathcmp(*(char **)a, *(char **)b, -1);
+}
+
+/*
+ * Expand "pat" using the directory index.  Only handles a pattern where the
+ * last path component has wildcards.
+ * Returns FAIL when the pattern can't be handled this way, OK otherwise.
+ */
+    static int
+rtp_dir_expand(char_u *pat, int flags, garray_T *gap)
+{
+    char_u	*dir;
+    char_u	*tail = gettail(pat);
+    char_u	*p;
+    char_u	*buf;
+    rtpdir_T	*rd;
+    regmatch_T	regmatch;
+    int		i;
+
+    if (tail == pat || vim_strpbrk(tail, (char_u *)"*?[") == NULL
+	    || vim_strpbrk(tail, (char_u *)"{`'$~\\") != NULL)
+	return FAIL;
+
+    dir = vim_strnsave(pat, (int)(tail - pat));
+    if (dir == NULL)
+	return FAIL;
+    if (vim_strchr(dir, '$') != NULL || *dir == '~')
+    {
+	p = expand_env_save_opt(dir, TRUE);
+	vim_free(dir);
+	dir = p;
+    }
+    if (dir == NULL || vim_strpbrk(dir, (char_u *)"*?[{`'$~\\") != NULL)
+    {
+	vim_free(dir);
+	return FAIL;
+    }
+
+    rd = rtp_dir_get(dir);
+    if (rd != NULL && rd->rd_names.ga_len > 0)
+    {
+	p = file_pat_to_reg_pat(tail, NULL, NULL, FALSE);
+	if (p == NULL)
+	{
+	    vim_free(dir);
+	    return FAIL;
+	}
+	regmatch.rm_ic = p_fic;
+	regmatch.regprog = vim_regcomp(p, RE_MAGIC);
+	vim_free(p);
+	buf = alloc(MAXPATHL);
+	if (regmatch.regprog != NULL && buf != NULL)
+	{
+	    for (i = 0; i < rd->rd_names.ga_len; ++i)
+	    {
+		p = ((char_u **)rd->rd_names.ga_data)[i];
+		if ((*p != '.' || *tail == '.')
+			&& vim_regexec(&regmatch, p, (colnr_T)0)
+			&& STRLEN(dir) + STRLEN(p) < MAXPATHL)
+		{
+		    STRCPY(buf, dir);
+		    STRCAT(buf, p);
+		    addfile(gap, buf, flags);
+		}
+	    }
+	}
+	vim_free(buf);
+	vim_regfree(regmatch.regprog);
+    }
+    vim_free(dir);
+
+    if (gap->ga_len > 1)
+	qsort(gap->ga_data, (size_t)gap->ga_len, sizeof(char_u *),
+								 rtp_pathcmp);
+    return OK;
+}
+#endif
+
+/*
+ * Clear the directory index, 'runtimepath' or 'packpath' was changed.
+ */
+    void
+clear_rtp_dirs(void)
+{
+#ifdef USE_RTP_DIRS
+    int		todo;
+    hashitem_T	*hi;
+
+    if (rtp_dirs == NULL)
+	return;
+    todo = (int)rtp_dirs->ht_used;
+    for (hi = rtp_dirs->ht_array; todo > 0; ++hi)
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    --todo;
+	    ga_clear_strings(&HI2RD(hi)->rd_names);
+	    vim_free(HI2RD(hi));
+	}
+    hash_clear(rtp_dirs);
+    VIM_CLEAR(rtp_dirs);
+#endif
+}
+
+/*
+ * Expand wildcards in "pat", a file name in a 'runtimepath' entry, like
+ * gen_expand_wildcards().
+ */
+    static int
+rtp_expand_wildcards(
+    char_u	*pat,
+    int		*num_files,
+    char_u	***files,
+    int		flags)
+{
+#ifdef USE_RTP_DIRS
+    garray_T	ga;
+
+    ga_init2(&ga, (int)sizeof(char_u *), 10);
+    if (rtp_dir_expand(pat, flags, &ga) == OK)
+    {
+	if (ga.ga_len == 0)
+	{
+	    ga_clear(&ga);
+	    return FAIL;
+	}
+	*num_files = ga.ga_len;
+	*files = (char_u **)ga.ga_data;
+	return OK;
+    }
+#endif
+    return gen_expand_wildcards(1, &pat, num_files, files, flags);
+}
+
 /*
  * Find the file "name" in all directories in "path" and invoke
  * "callback(fname, cookie)".
@@ -2551,7 +2786,7 @@ do_in_path(
 		    }
 
 		    /* Expand wildcards, invoke the callback for each match. */
-		    if (gen_expand_wildcards(1, &buf, &num_files, &files,
+		    if (rtp_expand_wildcards(buf, &num_files, &files,
 				  (flags & DIP_DIR) ? EW_DIR : EW_FILE) == OK)
 		    {
 			for (i = 0; i < num_files; ++i)
@@ -3342,6 +3577,38 @@ fopen_noinh_readbin(char *filename)
 }
 #endif
 
+#ifdef STARTUPTIME
+/*
+ * Return the category of a sourced script for "--startuptrace": the name of
+ * the last runtime directory in the path of "fname", such as "plugin" or
+ * "syntax".  "source" for other scripts.
+ */
+    static char *
+source_trace_cat(char_u *fname)
+{
+    static char *(dirs[]) = {"plugin", "ftplugin", "syntax", "indent",
+			   "autoload", "colors", "compiler", "keymap", "ftdetect",
+			   NULL};
+    char	*cat = "source";
+    char_u	*p;
+    char_u	*end;
+    int		i;
+
+    for (p = fname; *p != NUL; p = end)
+    {
+	for (end = p; *end != NUL && !vim_ispathsep(*end); ++end)
+	    ;
+	if (*end == NUL)
+	    break;  // the file name itself
+	for (i = 0; dirs[i] != NULL; ++i)
+	    if ((size_t)(end - p) == STRLEN(dirs[i])
+				    && STRNCMP(p, dirs[i], end - p) == 0)
+		cat = dirs[i];
+	++end;
+    }
+    return cat;
+}
+#endif
 
 /*
  * do_source: Read the file "fname" and execute its lines as EX commands.
@@ -3515,6 +3782,8 @@ do_source(
 #ifdef STARTUPTIME
     if (time_fd != NULL)
 	time_push(&tv_rel, &tv_start);
+    if (trace_fd != NULL)
+	trace_begin(source_trace_cat(fname_exp), fname_exp);
 #endif
 
 #ifdef FEAT_EVAL
@@ -3692,6 +3961,10 @@ almosttheend:
     if (do_profiling == PROF_YES)
 	prof_child_exit(&wait_start);		/* leaving a child now */
 # endif
+#endif
+#ifdef STARTUPTIME
+    if (trace_fd != NULL)
+	trace_end();
 #endif
     fclose(cookie.fp);
     vim_free(cookie.nextline);
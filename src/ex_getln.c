@@ -6600,6 +6600,65 @@ static int	viminfo_hisidx[HIST_COUNT] = {0, 0, 0, 0, 0};
 static int	viminfo_hislen[HIST_COUNT] = {0, 0, 0, 0, 0};
 static int	viminfo_add_at_front = FALSE;
 
+/*
+ * Hashtables to quickly find out if a history line read from viminfo is
+ * already known, with a large 'history' comparing with each entry is slow.
+ * viminfo_hist_ht[] has the lines in history[], viminfo_read_ht[] the lines
+ * in viminfo_history[].  The key is "hisstr".  Only valid while reading.
+ */
+static hashtab_T viminfo_hist_ht[HIST_COUNT];
+static hashtab_T viminfo_read_ht[HIST_COUNT];
+static int	viminfo_ht_valid = FALSE;
+
+/*
+ * Add history entry "p" to hashtable "ht", unless the text is already in it.
+ */
+    static void
+viminfo_ht_add(hashtab_T *ht, char_u *p)
+{
+    hash_T	hash = hash_hash(p);
+    hashitem_T	*hi = hash_lookup(ht, p, hash);
+
+    if (HASHITEM_EMPTY(hi))
+	hash_add_item(ht, hi, p, hash);
+}
+
+    static void
+clear_viminfo_ht(void)
+{
+    int	    type;
+
+    if (!viminfo_ht_valid)
+	return;
+    for (type = 0; type < HIST_COUNT; ++type)
+    {
+	hash_clear(&viminfo_hist_ht[type]);
+	hash_clear(&viminfo_read_ht[type]);
+    }
+    viminfo_ht_valid = FALSE;
+}
+
+/*
+ * Like in_history(), but use the hashtable when possible.
+ */
+    static int
+viminfo_in_history(int type, char_u *str, int sep, int writing)
+{
+    hashitem_T	*hi;
+    char_u	*p;
+
+    if (viminfo_add_at_front || !viminfo_ht_valid)
+	return in_history(type, str, viminfo_add_at_front, sep, writing);
+    hi = hash_find(&viminfo_hist_ht[type], str);
+    if (HASHITEM_EMPTY(hi))
+	return FALSE;
+    p = hi->hi_key;
+    if (type != HIST_SEARCH || sep == p[STRLEN(p) + 1])
+	return TRUE;
+    // Another search pattern with the same text may have this separator.
+    return in_history(type, str, FALSE, sep, writing);
+}
+
 /*
  * Translate a history type number to the associated character.
  */
@@ -6659,6 +6718,20 @@ prepare_viminfo_history(int asklen, int writing)
 	viminfo_hislen[type] = len;
 	viminfo_hisidx[type] = 0;
     }
+
+    clear_viminfo_ht();
+    for (type = 0; type < HIST_COUNT; ++type)
+    {
+	hash_init(&viminfo_hist_ht[type]);
+	hash_init(&viminfo_read_ht[type]);
+	if (history[type] != NULL && !viminfo_add_at_front)
+	    for (i = 0; i < hislen; i++)
+		if (history[type][i].hisstr != NULL
+				     && !(writing && history[type][i].viminfo))
+		    viminfo_ht_add(&viminfo_hist_ht[type],
+						     history[type][i].hisstr);
+    }
+    viminfo_ht_valid = TRUE;
 }
 
 /*
@@ -6681,8 +6754,8 @@ read_viminfo_history(vir_T *virp, int writing)
 	{
 	    int sep = (*val == ' ' ? NUL : *val);
 
-	    if (!in_history(type, val + (type == HIST_SEARCH),
-					  viminfo_add_at_front, sep, writing))
+	    if (!viminfo_in_history(type, val + (type == HIST_SEARCH),
+								sep, writing))
 	    {
 		/* Need to re-allocate to append the separator byte. */
 		len = STRLEN(val);
@@ -6753,20 +6826,23 @@ handle_viminfo_history(
 	    int idx;
 	    int overwrite = FALSE;
 
-	    if (!in_history(type, val, viminfo_add_at_front, sep, writing))
+	    if (!viminfo_in_history(type, val, sep, writing))
 	    {
 		/* If lines were written by an older Vim we need to avoid
 		 * getting duplicates. See if the entry already exists. */
-		for (idx = 0; idx < viminfo_hisidx[type]; ++idx)
-		{
-		    p = viminfo_history[type][idx].hisstr;
-		    if (STRCMP(val, p) == 0
-			  && (type != HIST_SEARCH || sep == p[STRLEN(p) + 1]))
+		idx = viminfo_hisidx[type];
+		if (!viminfo_ht_valid || !HASHITEM_EMPTY(
+				      hash_find(&viminfo_read_ht[type], val)))
+		    for (idx = 0; idx < viminfo_hisidx[type]; ++idx)
 		    {
-			overwrite = TRUE;
-			break;
+			p = viminfo_history[type][idx].hisstr;
+			if (STRCMP(val, p) == 0
+			  && (type != HIST_SEARCH || sep == p[STRLEN(p) + 1]))
+			{
+			    overwrite = TRUE;
+			    break;
+			}
 		    }
-		}
 
 		if (!overwrite)
 		{
@@ -6788,6 +6864,8 @@ handle_viminfo_history(
 			viminfo_history[type][idx].hisnum = 0;
 			viminfo_history[type][idx].viminfo = TRUE;
 			viminfo_hisidx[type]++;
+			if (viminfo_ht_valid)
+			    viminfo_ht_add(&viminfo_read_ht[type], p);
 		    }
 		}
 	    }
@@ -6924,6 +7002,7 @@ finish_viminfo_history(vir_T *virp)
     int	type;
     int merge = virp->vir_version >= VIMINFO_VERSION_WITH_HISTORY;
 
+    clear_viminfo_ht();
     for (type = 0; type < HIST_COUNT; ++type)
     {
 	if (history[type] == NULL)
@@ -6953,6 +7032,7 @@ write_viminfo_history(FILE *fp, int merge)
     int	    num_saved;
     int     round;
 
+    clear_viminfo_ht();
     init_history();
     if (hislen == 0)
 	return;
@@ -7103,6 +7103,13 @@ buf_reload(buf_T *buf, int orig_mode)
 	/* Invalidate diff info if necessary. */
 	diff_invalidate(curbuf);
 #endif
+#ifdef FEAT_SPELL
+	/* The text was replaced without calling changed_lines(). */
+	spell_cache_clear_buf(curbuf);
+#endif
+#ifdef FEAT_INS_EXPAND
+	ins_compl_words_free(curbuf);
+#endif
 
 	/* Restore the topline and cursor position and check it (lines may
 	 * have been removed). */
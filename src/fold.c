@@ -42,12 +42,38 @@ typedef struct
 
 #define MAX_LEVEL	20	/* maximum fold depth */
 
+/* typedef foldlvl_T {{{2 */
+/*
+ * The result of evaluating 'foldexpr' for each line is cached in the
+ * w_foldlvl growarray of the window, one foldlvl_T per line.  Entries are
+ * shifted when lines are inserted or deleted.  A line for which fl_valid is
+ * FALSE has to be evaluated again.
+ */
+typedef struct
+{
+    int		fl_valid;	/* TRUE when the other fields are valid */
+    int		fl_lvl;		/* "lvl" of the line */
+    int		fl_lvl_next;	/* "lvl_next" of the line */
+    int		fl_start;	/* "start" of the line */
+    int		fl_end;		/* "end" of the line */
+} foldlvl_T;
+
+/* Number of lines below a change that must get the same level as before the
+ * change, before the cached levels are used for the following lines. */
+#define FOLD_STABLE_LINES 3
+
+/* Number of lines for which postponed folds are computed at a time. */
+#define FOLD_LAZY_LINES 500
+
 /* static functions {{{2 */
 static void newFoldLevelWin(win_T *wp);
 static int checkCloseRec(garray_T *gap, linenr_T lnum, int level);
 static int foldFind(garray_T *gap, linenr_T lnum, fold_T **fpp);
 static int foldLevelWin(win_T *wp, linenr_T lnum);
-static void checkupdate(win_T *wp);
+static void checkupdate(win_T *wp, linenr_T lnum);
+static int foldLazyAllowed(win_T *wp);
+static void foldUpdateLazy(win_T *wp, linenr_T lnum);
+static void foldUpdateLazyStep(win_T *wp, linenr_T bot);
 static void setFoldRepeat(linenr_T lnum, long count, int do_open);
 static linenr_T setManualFold(linenr_T lnum, int opening, int recurse, int *donep);
 static linenr_T setManualFoldWin(win_T *wp, linenr_T lnum, int opening, int recurse, int *donep);
@@ -63,6 +89,8 @@ static void foldAddMarker(linenr_T lnum, char_u *marker, int markerlen);
 static void deleteFoldMarkers(fold_T *fp, int recursive, linenr_T lnum_off);
 static void foldDelMarker(linenr_T lnum, char_u *marker, int markerlen);
 static void foldUpdateIEMS(win_T *wp, linenr_T top, linenr_T bot);
+static void foldlvlInvalidate(win_T *wp, linenr_T top, linenr_T bot);
+static void foldlvlAdjust(win_T *wp, linenr_T line1, linenr_T line2, long amount, long amount_after);
 static void parseMarker(win_T *wp);
 
 static char *e_nofold = N_("E490: No fold found");
@@ -84,6 +112,17 @@ static linenr_T invalid_bot = (linenr_T)0;
 static linenr_T prev_lnum = 0;
 static int prev_lnum_lvl = -1;
 
+/*
+ * While updating folds for 'foldexpr', foldlvl_active is TRUE when the
+ * results of foldlevelExpr() are stored in w_foldlvl.  Lines below
+ * foldlvl_bot have not changed.  foldlvl_same is the number of lines up to
+ * foldlvl_lnum below foldlvl_bot that got the same result as before.
+ */
+static int foldlvl_active = FALSE;
+static linenr_T foldlvl_bot = 0;
+static linenr_T foldlvl_lnum = 0;
+static int foldlvl_same = 0;
+
 /* Flags used for "done" argument of setManualFold. */
 #define DONE_NOTHING	0
 #define DONE_ACTION	1	/* did close or open a fold */
@@ -104,7 +143,17 @@ copyFoldingState(win_T *wp_from, win_T *wp_to)
 {
     wp_to->w_fold_manual = wp_from->w_fold_manual;
     wp_to->w_foldinvalid = wp_from->w_foldinvalid;
+    wp_to->w_foldlazy = wp_from->w_foldlazy;
     cloneFoldGrowArray(&wp_from->w_folds, &wp_to->w_folds);
+
+    ga_clear(&wp_to->w_foldlvl);
+    if (wp_from->w_foldlvl.ga_len > 0
+	    && ga_grow(&wp_to->w_foldlvl, wp_from->w_foldlvl.ga_len) == OK)
+    {
+	mch_memmove(wp_to->w_foldlvl.ga_data, wp_from->w_foldlvl.ga_data,
+			sizeof(foldlvl_T) * wp_from->w_foldlvl.ga_len);
+	wp_to->w_foldlvl.ga_len = wp_from->w_foldlvl.ga_len;
+    }
 }
 
 /* hasAnyFolding() {{{2 */
@@ -154,7 +203,7 @@ hasFoldingWin(
     garray_T	*gap;
     int		low_level = 0;
 
-    checkupdate(win);
+    checkupdate(win, lnum);
 
     /*
      * Return quickly when there is no folding at all in this window.
@@ -253,7 +302,7 @@ foldLevel(linenr_T lnum)
     /* While updating the folds lines between invalid_top and invalid_bot have
      * an undefined fold level.  Otherwise update the folds first. */
     if (invalid_top == (linenr_T)0)
-	checkupdate(curwin);
+	checkupdate(curwin, lnum);
     else if (lnum == prev_lnum && prev_lnum_lvl >= 0)
 	return prev_lnum_lvl;
     else if (lnum >= invalid_top && lnum <= invalid_bot)
@@ -446,7 +495,7 @@ foldOpenCursor(void)
 {
     int		done;
 
-    checkupdate(curwin);
+    checkupdate(curwin, curwin->w_cursor.lnum);
     if (hasAnyFolding(curwin))
 	for (;;)
 	{
@@ -492,7 +541,7 @@ newFoldLevelWin(win_T *wp)
     fold_T	*fp;
     int		i;
 
-    checkupdate(wp);
+    checkupdate(wp, (linenr_T)0);
     if (wp->w_fold_manual)
     {
 	/* Set all flags for the first level of folds to FD_LEVEL.  Following
@@ -515,7 +564,7 @@ foldCheckClose(void)
 {
     if (*p_fcl != NUL)	/* can only be "all" right now */
     {
-	checkupdate(curwin);
+	checkupdate(curwin, (linenr_T)0);
 	if (checkCloseRec(&curwin->w_folds, curwin->w_cursor.lnum,
 							(int)curwin->w_p_fdl))
 	    changed_window_setting();
@@ -602,7 +651,7 @@ foldCreate(linenr_T start, linenr_T end)
 	return;
     }
 
-    checkupdate(curwin);
+    checkupdate(curwin, (linenr_T)MAXLNUM);
 
     /* Find the place to insert the new fold. */
     gap = &curwin->w_folds;
@@ -718,7 +767,7 @@ deleteFold(
     linenr_T	first_lnum = MAXLNUM;
     linenr_T	last_lnum = 0;
 
-    checkupdate(curwin);
+    checkupdate(curwin, (linenr_T)MAXLNUM);
 
     while (lnum <= end)
     {
@@ -796,7 +845,9 @@ deleteFold(
 clearFolding(win_T *win)
 {
     deleteFoldRecurse(&win->w_folds);
+    ga_clear(&win->w_foldlvl);
     win->w_foldinvalid = FALSE;
+    win->w_foldlazy = 0;
 }
 
 /* foldUpdate() {{{2 */
@@ -812,7 +863,19 @@ foldUpdate(win_T *wp, linenr_T top, linenr_T bot)
     fold_T	*fp;
 
     if (disable_fold_update > 0)
+    {
+	/* The cached levels of the changed lines are no longer valid. */
+	foldlvlInvalidate(wp, top, bot);
+	return;
+    }
+
+    /* Folds that have not been computed yet don't need to be updated. */
+    if ((wp->w_foldinvalid && foldLazyAllowed(wp))
+	    || (wp->w_foldlazy != 0 && top >= wp->w_foldlazy))
+    {
+	foldlvlInvalidate(wp, top, bot);
 	return;
+    }
 
     /* Mark all folds from top to bot as maybe-small. */
     (void)foldFind(&wp->w_folds, top, &fp);
@@ -854,6 +917,56 @@ foldUpdateAll(win_T *win)
     redraw_win_later(win, NOT_VALID);
 }
 
+/* foldLazyFinish() {{{2 */
+/*
+ * Compute the folds in window "wp" that were postponed, using "fdm" for
+ * 'foldmethod'.  Used when 'foldmethod' was changed to "manual".
+ */
+    void
+foldLazyFinish(win_T *wp, char_u *fdm)
+{
+    char_u	*save_fdm = wp->w_p_fdm;
+
+    if (wp->w_foldlazy == 0)
+	return;
+    wp->w_p_fdm = fdm;
+    checkupdate(wp, (linenr_T)MAXLNUM);
+    wp->w_p_fdm = save_fdm;
+}
+
+# if defined(FEAT_TIMERS) || defined(PROTO)
+/* foldUpdateIdle() {{{2 */
+/*
+ * Called while waiting for a character: compute some of the postponed folds
+ * for the windows in the current tab page.
+ * "next_due" is the time in msec until a timer is due, -1 if none.  Returns
+ * the time until this needs to be called again.
+ */
+    long
+foldUpdateIdle(long next_due)
+{
+    win_T	*wp;
+    int		did_step = FALSE;
+
+    if (disable_fold_update > 0 || invalid_top != (linenr_T)0)
+	return next_due;
+
+    FOR_ALL_WINDOWS(wp)
+	if (wp->w_foldlazy != 0 && !wp->w_foldinvalid)
+	{
+	    if (!did_step)
+	    {
+		foldUpdateLazyStep(wp, wp->w_foldlazy + FOLD_LAZY_LINES);
+		did_step = TRUE;
+	    }
+	    if (wp->w_foldlazy != 0)
+		/* More to do, come back soon. */
+		return next_due < 0 || next_due > 1 ? 1 : next_due;
+	}
+    return next_due;
+}
+# endif
+
 /* foldMoveTo() {{{2 */
 /*
  * If "updown" is FALSE: Move to the start or end of the fold.
@@ -878,7 +991,7 @@ foldMoveTo(
     int		level;
     int		last;
 
-    checkupdate(curwin);
+    checkupdate(curwin, (linenr_T)MAXLNUM);
 
     /* Repeat "count" times. */
     for (n = 0; n < count; ++n)
@@ -1001,6 +1114,7 @@ foldMoveTo(
 foldInitWin(win_T *new_win)
 {
     ga_init2(&new_win->w_folds, (int)sizeof(fold_T), 10);
+    ga_init2(&new_win->w_foldlvl, (int)sizeof(foldlvl_T), 100);
 }
 
 /* find_wl_entry() {{{2 */
@@ -1179,15 +1293,104 @@ foldLevelWin(win_T *wp, linenr_T lnum)
 /* checkupdate() {{{2 */
 /*
  * Check if the folds in window "wp" are invalid and update them if needed.
+ * When possible the folds are only computed as far as needed for line
+ * "lnum", the rest is done later.  Use MAXLNUM to compute all folds, zero to
+ * compute none.
  */
     static void
-checkupdate(win_T *wp)
+checkupdate(win_T *wp, linenr_T lnum)
 {
     if (wp->w_foldinvalid)
     {
-	foldUpdate(wp, (linenr_T)1, (linenr_T)MAXLNUM); /* will update all */
+	if (foldLazyAllowed(wp))
+	{
+	    /* Start computing the folds at the first line.  Existing folds
+	     * are kept to remember which ones were open or closed. */
+	    setSmallMaybe(&wp->w_folds);
+	    ga_clear(&wp->w_foldlvl);
+	    wp->w_foldlazy = 1;
+	}
+	else
+	{
+	    wp->w_foldlazy = 0;
+	    foldUpdate(wp, (linenr_T)1, (linenr_T)MAXLNUM); /* will update all */
+	}
 	wp->w_foldinvalid = FALSE;
     }
+    if (wp->w_foldlazy != 0 && lnum > 0)
+	foldUpdateLazy(wp, lnum);
+}
+
+/* foldLazyAllowed() {{{2 */
+/*
+ * Return TRUE if computing the folds for window "wp" may be postponed for
+ * lines that are not used yet.
+ */
+    static int
+foldLazyAllowed(win_T *wp)
+{
+    return foldmethodIsIndent(wp)
+	    || foldmethodIsExpr(wp)
+	    || foldmethodIsSyntax(wp);
+}
+
+/* foldUpdateLazy() {{{2 */
+/*
+ * Compute the folds in window "wp" that were postponed until the fold that
+ * contains line "lnum" is complete.
+ */
+    static void
+foldUpdateLazy(win_T *wp, linenr_T lnum)
+{
+    fold_T	*fp;
+
+    /* Can't do this while updating folds, e.g. when 'foldexpr' uses
+     * foldlevel(). */
+    if (invalid_top != (linenr_T)0)
+	return;
+
+    while (wp->w_foldlazy != 0 && !got_int)
+    {
+	/* Done when "lnum" is above the lines that were not computed and
+	 * the fold it is in doesn't continue into them. */
+	if (lnum < wp->w_foldlazy - 1
+		&& (!foldFind(&wp->w_folds, lnum, &fp)
+			       || fp->fd_top + fp->fd_len < wp->w_foldlazy))
+	    break;
+	if (lnum == MAXLNUM)
+	    foldUpdateLazyStep(wp, (linenr_T)MAXLNUM);
+	else
+	    foldUpdateLazyStep(wp, (lnum > wp->w_foldlazy
+					       ? lnum : wp->w_foldlazy)
+							    + FOLD_LAZY_LINES);
+    }
+}
+
+/* foldUpdateLazyStep() {{{2 */
+/*
+ * Compute the postponed folds in window "wp" up to line "bot".
+ */
+    static void
+foldUpdateLazyStep(win_T *wp, linenr_T bot)
+{
+    linenr_T	top = wp->w_foldlazy;
+    int		save_got_int = got_int;
+
+    if (bot >= wp->w_buffer->b_ml.ml_line_count)
+    {
+	bot = wp->w_buffer->b_ml.ml_line_count;
+	wp->w_foldlazy = 0;
+    }
+    else
+	wp->w_foldlazy = bot + 1;
+
+    /* reset got_int here, otherwise it won't work */
+    got_int = FALSE;
+    foldUpdateIEMS(wp, top, bot);
+    if (got_int)
+	/* Interrupted: try again later. */
+	wp->w_foldlazy = top;
+    got_int |= save_got_int;
 }
 
 /* setFoldRepeat() {{{2 */
@@ -1282,7 +1485,7 @@ setManualFoldWin(
     linenr_T	off = 0;
     int		done = 0;
 
-    checkupdate(wp);
+    checkupdate(wp, lnum);
 
     /*
      * Find the fold, open or close it.
@@ -1469,6 +1672,19 @@ foldMarkAdjust(
     long	amount,
     long	amount_after)
 {
+    foldlvlAdjust(wp, line1, line2, amount, amount_after);
+
+    /* Keep the first line for which folds were not computed yet. */
+    if (wp->w_foldlazy != 0 && line1 < wp->w_foldlazy)
+    {
+	if (line2 < wp->w_foldlazy)
+	    wp->w_foldlazy += amount_after;
+	else if (amount == MAXLNUM)
+	    wp->w_foldlazy = line1;
+	else
+	    wp->w_foldlazy += amount;
+    }
+
     /* If deleting marks from line1 to line2, but not deleting all those
      * lines, set line2 so that only deleted lines have their folds removed. */
     if (amount == MAXLNUM && line2 >= line1 && line2 - line1 >= -amount_after)
@@ -1608,7 +1824,7 @@ foldMarkAdjustRecurse(
     int
 getDeepestNesting(void)
 {
-    checkupdate(curwin);
+    checkupdate(curwin, (linenr_T)MAXLNUM);
     return getDeepestNestingRecurse(&curwin->w_folds);
 }
 
@@ -2103,6 +2319,9 @@ static void foldlevelIndent(fline_T *flp);
 static void foldlevelDiff(fline_T *flp);
 #endif
 static void foldlevelExpr(fline_T *flp);
+static int foldlvlSeed(fline_T *flp);
+static foldlvl_T *foldlvlGet(win_T *wp, linenr_T lnum);
+static void foldlvlStore(fline_T *flp, linenr_T lnum);
 static void foldlevelMarker(fline_T *flp);
 static void foldlevelSyntax(fline_T *flp);
 
@@ -2123,7 +2342,10 @@ foldUpdateIEMS(win_T *wp, linenr_T top, linenr_T bot)
 
     /* Avoid problems when being called recursively. */
     if (invalid_top != (linenr_T)0)
+    {
+	foldlvlInvalidate(wp, top, bot);
 	return;
+    }
 
     if (wp->w_foldinvalid)
     {
@@ -2165,6 +2387,10 @@ foldUpdateIEMS(win_T *wp, linenr_T top, linenr_T bot)
     invalid_top = top;
     invalid_bot = bot;
 
+    foldlvl_bot = bot;
+    foldlvl_lnum = 0;
+    foldlvl_same = 0;
+
     if (foldmethodIsMarker(wp))
     {
 	getlevel = foldlevelMarker;
@@ -2215,20 +2441,35 @@ foldUpdateIEMS(win_T *wp, linenr_T top, linenr_T bot)
 	else
 	    getlevel = foldlevelIndent;
 
-	/* Backup to a line for which the fold level is defined.  Since it's
-	 * always defined for line one, we will stop there. */
+	/* For "expr" the level of the line above is normally cached, so that
+	 * the level of this line can be computed directly.  Otherwise backup
+	 * to a line for which the fold level is defined.  Since it's always
+	 * defined for line one, we will stop there. */
 	fline.lvl = -1;
-	for ( ; !got_int; --fline.lnum)
+	if (getlevel != foldlevelExpr || !foldlvlSeed(&fline))
 	{
-	    /* Reset lvl_next each time, because it will be set to a value for
-	     * the next line, but we search backwards here. */
-	    fline.lvl_next = -1;
-	    getlevel(&fline);
-	    if (fline.lvl >= 0)
-		break;
+	    for ( ; !got_int; --fline.lnum)
+	    {
+		/* Reset lvl_next each time, because it will be set to a value
+		 * for the next line, but we search backwards here. */
+		fline.lvl_next = -1;
+		getlevel(&fline);
+		if (fline.lvl >= 0)
+		    break;
+	    }
+
+	    /* When the level is defined it doesn't depend on the lines
+	     * above, thus it can be cached. */
+	    if (getlevel == foldlevelExpr && fline.lvl >= 0)
+		foldlvlStore(&fline, fline.lnum);
 	}
+	foldlvl_active = (getlevel == foldlevelExpr);
     }
 
+    /* The cached 'foldexpr' levels are only kept for "expr". */
+    if (getlevel != foldlevelExpr)
+	ga_clear(&wp->w_foldlvl);
+
     /*
      * If folding is defined by the syntax, it is possible that a change in
      * one line will cause all sub-folds of the current fold to change (e.g.,
@@ -2322,6 +2563,11 @@ foldUpdateIEMS(win_T *wp, linenr_T top, linenr_T bot)
     /* There can't be any folds from start until end now. */
     foldRemove(&wp->w_folds, start, end);
 
+    /* When interrupted the folds don't match the cached levels. */
+    foldlvl_active = FALSE;
+    if (got_int)
+	ga_clear(&wp->w_foldlvl);
+
     /* If some fold changed, need to redraw and position cursor. */
     if (fold_changed && wp->w_p_fen)
 	changed_window_setting_win(wp);
@@ -3244,7 +3490,8 @@ foldlevelDiff(fline_T *flp)
 /* foldlevelExpr() {{{2 */
 /*
  * Low level function to get the foldlevel for the "expr" method.
- * Doesn't use any caching.
+ * When lines below a change got the same level as before, the cached level
+ * is used for the following lines.
  * Returns a level of -1 if the foldlevel depends on surrounding lines.
  */
     static void
@@ -3259,6 +3506,25 @@ foldlevelExpr(fline_T *flp)
     int		c;
     linenr_T	lnum = flp->lnum + flp->off;
     int		save_keytyped;
+    foldlvl_T	*fl;
+
+    if (foldlvl_active && foldlvl_same >= FOLD_STABLE_LINES
+						   && lnum == foldlvl_lnum + 1)
+    {
+	/* The line above got the same level as before the change and this
+	 * line did not change, thus it will get the same level too. */
+	fl = foldlvlGet(flp->wp, lnum);
+	if (fl != NULL)
+	{
+	    flp->had_end = flp->end;
+	    flp->lvl = fl->fl_lvl;
+	    flp->lvl_next = fl->fl_lvl_next;
+	    flp->start = fl->fl_start;
+	    flp->end = fl->fl_end;
+	    foldlvl_lnum = lnum;
+	    return;
+	}
+    }
 
     win = curwin;
     curwin = flp->wp;
@@ -3340,9 +3606,163 @@ foldlevelExpr(fline_T *flp)
 
     curwin = win;
     curbuf = curwin->w_buffer;
+
+    if (foldlvl_active)
+	foldlvlStore(flp, lnum);
 #endif
 }
 
+/* foldlvlSeed() {{{2 */
+/*
+ * Get the level for the "expr" method of line "flp->lnum", using the cached
+ * level of the line above it.
+ * Returns FALSE when that level is not available or the level of the line is
+ * still undefined.
+ */
+    static int
+foldlvlSeed(fline_T *flp)
+{
+    foldlvl_T	*fl;
+
+    if (flp->lnum > 1)
+    {
+	fl = foldlvlGet(flp->wp, flp->lnum - 1);
+	if (fl == NULL)
+	    return FALSE;
+	flp->lvl = fl->fl_lvl_next;
+	flp->end = fl->fl_end;
+    }
+    foldlvl_active = TRUE;
+    foldlevelExpr(flp);
+    foldlvl_active = FALSE;
+    if (flp->lvl >= 0)
+	return TRUE;
+
+    flp->lvl = -1;
+    flp->end = MAX_LEVEL + 1;
+    return FALSE;
+}
+
+/* foldlvlGet() {{{2 */
+/*
+ * Return the cached 'foldexpr' result for line "lnum" in window "wp".
+ * Returns NULL when there is none.
+ */
+    static foldlvl_T *
+foldlvlGet(win_T *wp, linenr_T lnum)
+{
+    foldlvl_T	*fl;
+
+    if (lnum < 1 || lnum > wp->w_foldlvl.ga_len)
+	return NULL;
+    fl = (foldlvl_T *)wp->w_foldlvl.ga_data + lnum - 1;
+    return fl->fl_valid ? fl : NULL;
+}
+
+/* foldlvlStore() {{{2 */
+/*
+ * Store the 'foldexpr' result in "flp" for line "lnum" in the cache.
+ * Counts the lines below the change that got the same result as before.
+ */
+    static void
+foldlvlStore(fline_T *flp, linenr_T lnum)
+{
+    garray_T	*gap = &flp->wp->w_foldlvl;
+    foldlvl_T	*fl;
+    linenr_T	len;
+
+    if (lnum > gap->ga_len)
+    {
+	/* Make room for all lines at once, most likely all of them will be
+	 * stored. */
+	len = flp->wp->w_buffer->b_ml.ml_line_count;
+	if (len < lnum)
+	    len = lnum;
+	if (ga_grow(gap, len - gap->ga_len) == FAIL)
+	    return;
+	vim_memset((foldlvl_T *)gap->ga_data + gap->ga_len, 0,
+				   sizeof(foldlvl_T) * (len - gap->ga_len));
+	gap->ga_len = len;
+    }
+
+    fl = (foldlvl_T *)gap->ga_data + lnum - 1;
+    if (lnum > foldlvl_bot && lnum == foldlvl_lnum + 1 && fl->fl_valid
+	    && fl->fl_lvl == flp->lvl
+	    && fl->fl_lvl_next == flp->lvl_next
+	    && fl->fl_start == flp->start
+	    && fl->fl_end == flp->end)
+	++foldlvl_same;
+    else
+	foldlvl_same = 0;
+    foldlvl_lnum = lnum;
+
+    fl->fl_valid = TRUE;
+    fl->fl_lvl = flp->lvl;
+    fl->fl_lvl_next = flp->lvl_next;
+    fl->fl_start = flp->start;
+    fl->fl_end = flp->end;
+}
+
+/* foldlvlInvalidate() {{{2 */
+/*
+ * Lines "top" to "bot" changed without updating the folds: the cached
+ * 'foldexpr' levels for them can't be used.
+ */
+    static void
+foldlvlInvalidate(win_T *wp, linenr_T top, linenr_T bot)
+{
+    linenr_T	lnum;
+
+    if (bot > wp->w_foldlvl.ga_len)
+	bot = wp->w_foldlvl.ga_len;
+    for (lnum = top; lnum <= bot; ++lnum)
+	((foldlvl_T *)wp->w_foldlvl.ga_data)[lnum - 1].fl_valid = FALSE;
+}
+
+/* foldlvlAdjust() {{{2 */
+/*
+ * Update the cached 'foldexpr' levels for inserted/deleted lines.  The
+ * arguments are as for foldMarkAdjust().
+ */
+    static void
+foldlvlAdjust(
+    win_T	*wp,
+    linenr_T	line1,
+    linenr_T	line2,
+    long	amount,
+    long	amount_after)
+{
+    garray_T	*gap = &wp->w_foldlvl;
+    foldlvl_T	*fl = (foldlvl_T *)gap->ga_data;
+
+    if (line1 > gap->ga_len || (amount == 0 && amount_after == 0))
+	return;
+
+    if (amount == MAXLNUM && line2 != MAXLNUM
+					  && amount_after == line1 - line2 - 1)
+    {
+	/* Lines "line1" to "line2" are deleted. */
+	if (line2 > gap->ga_len)
+	    line2 = gap->ga_len;
+	mch_memmove(fl + line1 - 1, fl + line2,
+				   sizeof(foldlvl_T) * (gap->ga_len - line2));
+	gap->ga_len -= line2 - line1 + 1;
+    }
+    else if (line2 == MAXLNUM && amount > 0 && amount_after == 0
+					       && ga_grow(gap, amount) == OK)
+    {
+	/* "amount" lines are inserted above "line1", their level is not
+	 * known yet. */
+	fl = (foldlvl_T *)gap->ga_data;
+	mch_memmove(fl + line1 - 1 + amount, fl + line1 - 1,
+			       sizeof(foldlvl_T) * (gap->ga_len - line1 + 1));
+	vim_memset(fl + line1 - 1, 0, sizeof(foldlvl_T) * amount);
+	gap->ga_len += amount;
+    }
+    else
+	ga_clear(gap);
+}
+
 /* parseMarker() {{{2 */
 /*
  * Parse 'foldmarker' and set "foldendmarker", "foldstartmarkerlen" and
@@ -3488,6 +3908,7 @@ static int put_fold_open_close(FILE *fd, fold_T *fp, linenr_T off);
     int
 put_folds(FILE *fd, win_T *wp)
 {
+    checkupdate(wp, (linenr_T)MAXLNUM);
     if (foldmethodIsManual(wp))
     {
 	if (put_line(fd, "silent! normal! zE") == FAIL
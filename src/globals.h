@@ -1623,6 +1623,8 @@ EXTERN time_T starttime;
 
 #ifdef STARTUPTIME
 EXTERN FILE *time_fd INIT(= NULL);  /* where to write startup timing */
+EXTERN FILE *trace_fd INIT(= NULL); // where to write the startup trace
+EXTERN long_u alloc_count INIT(= 0); // number of lalloc() calls
 #endif
 
 /*
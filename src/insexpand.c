@@ -161,8 +161,66 @@ static int	  compl_was_interrupted = FALSE;
 // stop looking for matches.
 static int	  compl_interrupted = FALSE;
 
+#ifdef FEAT_RELTIME
+// When typing, searching for matches stops after this many msec, so that the
+// popup menu is shown with the matches found so far.  The search continues
+// while waiting for the next key, see ins_compl_search_more().
+# define COMPL_SEARCH_SLICE 100
+
+// Set when searching was stopped because the time slice was used up.
+static int	  compl_search_more = FALSE;
+
+// Set while ins_compl_search_more() is searching.  A typed key then stops
+// searching and is handled by edit() as usual.
+static int	  compl_searching_more = FALSE;
+
+// Set when a key was typed while "compl_searching_more" is set.
+static int	  compl_key_typed = FALSE;
+
+// Direction of the search when it was stopped, "compl_direction" changes
+// when CTRL-P is typed after CTRL-N.
+static int	  compl_search_dir = FORWARD;
+#endif
+
 static int	  compl_restarting = FALSE;	// don't insert match
 
+// Index of the words in a buffer, used for ^N/^P to find matches in other
+// buffers without searching all their lines.  Keeps the words of each line,
+// to find the matches in the order of the text, and a table of the distinct
+// words sorted ignoring case, to find the words with a prefix quickly.
+// Changed lines are found through ins_compl_words_changed() and indexed
+// again when used.
+struct compl_words_S
+{
+    garray_T	cws_lines;	// words of each line, see compl_words_find(),
+				// NULL when the line needs to be indexed
+    long	cws_unindexed;	// number of NULL lines in "cws_lines"
+    garray_T	cws_table;	// compl_word_T pointers, see
+				// compl_word_cmp() for the order
+    char_u	*cws_isk;	// 'iskeyword' used for the words
+    int		cws_used;	// "compl_search_count" when last used
+};
+
+// Entry in "cws_table".
+typedef struct
+{
+    long	cw_count;	// number of times the word is in "cws_lines",
+				// entries with zero are dropped later
+    int		cw_wanted;	// "compl_words_wanted" when the word matches
+				// and wasn't found in the lines yet
+    char_u	cw_word[1];	// the word, actually longer
+} compl_word_T;
+
+// Number used to mark the words in "cws_table" a search is looking for.
+static int	  compl_words_wanted = 0;
+
+// Words of a line without words.
+static char_u	  compl_no_words[1] = {NUL};
+
+// Incremented when a completion starts, used to free the word index of
+// buffers that are no longer completed from.
+static int	  compl_search_count = 0;
+
 // When the first completion is done "compl_started" is set.  When it's
 // FALSE the word to be completed must be located.
 static int	  compl_started = FALSE;
@@ -209,6 +267,7 @@ static int  ins_compl_pum_key(int c);
 static int  ins_compl_key2count(int c);
 static void show_pum(int prev_w_wrow, int prev_w_leftcol);
 static unsigned  quote_meta(char_u *dest, char_u *str, int len);
+static int  ins_compl_buf_words(buf_T *buf);
 #endif // FEAT_INS_EXPAND
 
 #ifdef FEAT_SPELL
@@ -1470,6 +1529,9 @@ ins_compl_free(void)
 
     VIM_CLEAR(compl_pattern);
     VIM_CLEAR(compl_leader);
+#ifdef FEAT_RELTIME
+    compl_search_more = FALSE;
+#endif
 
     if (compl_first_match == NULL)
 	return;
@@ -1500,6 +1562,9 @@ ins_compl_clear(void)
 {
     compl_cont_status = 0;
     compl_started = FALSE;
+#ifdef FEAT_RELTIME
+    compl_search_more = FALSE;
+#endif
     compl_matches = 0;
     VIM_CLEAR(compl_pattern);
     VIM_CLEAR(compl_leader);
@@ -2448,6 +2513,512 @@ ins_compl_add_tv(typval_T *tv, int dir)
 }
 #endif
 
+/*
+ * Find the words in "line" of "buf" for the word index.  A word is a sequence
+ * of keyword characters of the same class, like what find_word_end() uses.
+ * Words of one character are never completed and are skipped.
+ * If "dest" is not NULL the words are copied there, each followed by a NUL.
+ * Returns the number of bytes needed for the words.
+ */
+    static int
+compl_words_find(buf_T *buf, char_u *line, char_u *dest)
+{
+    char_u	*p = line;
+    char_u	*start;
+    int		word_class;
+    int		chars;
+    int		len = 0;
+
+    while (*p != NUL)
+    {
+	word_class = mb_get_class_buf(p, buf);
+	start = p;
+	p += (*mb_ptr2len)(p);
+	if (word_class < 2)
+	    continue;
+	for (chars = 1; *p != NUL && mb_get_class_buf(p, buf) == word_class;
+								       ++chars)
+	    p += (*mb_ptr2len)(p);
+	if (chars > 1)
+	{
+	    if (dest != NULL)
+	    {
+		mch_memmove(dest + len, start, (size_t)(p - start));
+		dest[len + (p - start)] = NUL;
+	    }
+	    len += (int)(p - start) + 1;
+	}
+    }
+    return len;
+}
+
+/*
+ * Compare two words for the order of "cws_table": ignoring case, so that the
+ * words with a prefix are together also when 'ignorecase' is set, and on the
+ * bytes for words that only differ in case.
+ */
+    static int
+compl_word_cmp(char_u *w1, char_u *w2)
+{
+    int	    i;
+    int	    r = 0;
+
+    // Most words are ASCII, only use the slow MB_STRICMP() for the rest.
+    for (i = 0; w1[i] < 0x80 && w2[i] < 0x80; ++i)
+    {
+	r = TOLOWER_ASC(w1[i]) - TOLOWER_ASC(w2[i]);
+	if (r != 0 || w1[i] == NUL)
+	    break;
+    }
+    if (r == 0 && (w1[i] != NUL || w2[i] != NUL))
+	r = MB_STRICMP(w1 + i, w2 + i);
+    return r != 0 ? r : STRCMP(w1, w2);
+}
+
+/*
+ * Function given to qsort() to sort pointers to words.
+ */
+    static int
+compl_word_sort_cmp(const void *s1, const void *s2)
+{
+    return compl_word_cmp(*(char_u **)s1, *(char_u **)s2);
+}
+
+/*
+ * Find "word" in the table of "cws".  Returns NULL when it is not there.
+ */
+    static compl_word_T *
+compl_word_lookup(compl_words_T *cws, char_u *word)
+{
+    compl_word_T    **table = (compl_word_T **)cws->cws_table.ga_data;
+    int		    lo = 0;
+    int		    hi = cws->cws_table.ga_len - 1;
+    int		    mid;
+    int		    r;
+
+    while (lo <= hi)
+    {
+	mid = (lo + hi) / 2;
+	r = compl_word_cmp(table[mid]->cw_word, word);
+	if (r == 0)
+	    return table[mid];
+	if (r < 0)
+	    lo = mid + 1;
+	else
+	    hi = mid - 1;
+    }
+    return NULL;
+}
+
+/*
+ * Add "count" to the count of each word in "words" in the table of "cws".
+ * Used with -1 before the words of a line are freed.
+ */
+    static void
+compl_words_count(compl_words_T *cws, char_u *words, int count)
+{
+    char_u	    *w;
+    compl_word_T    *cw;
+
+    for (w = words; *w != NUL; w += STRLEN(w) + 1)
+	if ((cw = compl_word_lookup(cws, w)) != NULL)
+	    cw->cw_count += count;
+}
+
+/*
+ * Add the words in "new_ga", pointers to words in "cws_lines" sorted with
+ * compl_word_cmp(), to the table of "cws".  A word may appear more than once.
+ * Also drops the entries that are no longer used.
+ * Returns FAIL when out of memory, the counts are wrong then.
+ */
+    static int
+compl_words_merge(compl_words_T *cws, garray_T *new_ga)
+{
+    garray_T	    ga;
+    compl_word_T    **table = (compl_word_T **)cws->cws_table.ga_data;
+    char_u	    **new_words = (char_u **)new_ga->ga_data;
+    compl_word_T    *cw;
+    int		    ti = 0;
+    int		    ni = 0;
+    int		    r;
+    int		    len;
+    int		    ret = OK;
+
+    ga_init2(&ga, (int)sizeof(compl_word_T *), 100);
+    if (ga_grow(&ga, cws->cws_table.ga_len + new_ga->ga_len) == FAIL)
+	return FAIL;
+    while (ti < cws->cws_table.ga_len || ni < new_ga->ga_len)
+    {
+	if (ni == new_ga->ga_len)
+	    r = -1;
+	else if (ti == cws->cws_table.ga_len)
+	    r = 1;
+	else
+	    r = compl_word_cmp(table[ti]->cw_word, new_words[ni]);
+
+	if (r <= 0)
+	    cw = table[ti++];
+	else
+	{
+	    len = (int)STRLEN(new_words[ni]);
+	    cw = ret == FAIL ? NULL
+		       : (compl_word_T *)alloc(sizeof(compl_word_T) + len);
+	    if (cw == NULL)
+	    {
+		ret = FAIL;
+		++ni;
+		continue;
+	    }
+	    mch_memmove(cw->cw_word, new_words[ni], (size_t)len + 1);
+	    cw->cw_count = 0;
+	    cw->cw_wanted = 0;
+	}
+	while (r >= 0 && ni < new_ga->ga_len
+			       && STRCMP(new_words[ni], cw->cw_word) == 0)
+	{
+	    ++cw->cw_count;
+	    ++ni;
+	}
+
+	if (cw->cw_count > 0)
+	    ((compl_word_T **)ga.ga_data)[ga.ga_len++] = cw;
+	else
+	    vim_free(cw);
+    }
+    ga_clear(&cws->cws_table);
+    cws->cws_table = ga;
+    return ret;
+}
+
+/*
+ * Return the words of line "lnum" in the word index of "buf", each followed
+ * by a NUL and ending in an empty word.  The line must have been indexed with
+ * compl_words_update().
+ */
+    static char_u *
+compl_words_get(buf_T *buf, linenr_T lnum)
+{
+    return ((char_u **)buf->b_compl_words->cws_lines.ga_data)[lnum - 1];
+}
+
+/*
+ * Index the lines of "buf" that were changed or not indexed yet and update
+ * the table of words.  When interrupted some lines are not indexed.
+ * Returns FAIL when out of memory, the index is freed then.
+ */
+    static int
+compl_words_update(buf_T *buf)
+{
+    compl_words_T   *cws = buf->b_compl_words;
+    char_u	    **wordsp;
+    char_u	    *line;
+    char_u	    *w;
+    garray_T	    new_ga;
+    linenr_T	    lnum;
+    int		    len;
+    int		    ret = OK;
+
+    if (cws->cws_unindexed == 0)
+	return OK;
+    ga_init2(&new_ga, (int)sizeof(char_u *), 1000);
+    wordsp = (char_u **)cws->cws_lines.ga_data;
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count && cws->cws_unindexed > 0
+					       && ret == OK; ++lnum, ++wordsp)
+    {
+	if (*wordsp != NULL)
+	    continue;
+	line = ml_get_buf(buf, lnum, FALSE);
+	len = compl_words_find(buf, line, NULL);
+	if (len == 0)
+	    *wordsp = compl_no_words;
+	else if ((*wordsp = alloc(len + 1)) != NULL)
+	{
+	    compl_words_find(buf, line, *wordsp);
+	    (*wordsp)[len] = NUL;
+	}
+	else
+	{
+	    ret = FAIL;
+	    break;
+	}
+	--cws->cws_unindexed;
+
+	// Collect the words, they are counted in the table below.
+	for (w = *wordsp; *w != NUL; w += STRLEN(w) + 1)
+	{
+	    if (ga_grow(&new_ga, 1) == FAIL)
+	    {
+		ret = FAIL;
+		break;
+	    }
+	    ((char_u **)new_ga.ga_data)[new_ga.ga_len++] = w;
+	}
+	line_breakcheck();
+	if (got_int)
+	    break;
+    }
+
+    if (ret == OK && new_ga.ga_len > 0)
+    {
+	qsort(new_ga.ga_data, (size_t)new_ga.ga_len, sizeof(char_u *),
+							  compl_word_sort_cmp);
+	ret = compl_words_merge(cws, &new_ga);
+    }
+    ga_clear(&new_ga);
+    if (ret == FAIL)
+	ins_compl_words_free(buf);
+    return ret;
+}
+
+/*
+ * Free the words of one line of the word index.
+ */
+    static void
+compl_words_free_line(char_u *words)
+{
+    if (words != compl_no_words)
+	vim_free(words);
+}
+
+/*
+ * Mark the words in the table of "cws" that match the completion pattern,
+ * ignoring case when "ic" is TRUE.
+ * Returns the number of words marked.
+ */
+    static int
+compl_words_mark(compl_words_T *cws, int ic)
+{
+    compl_word_T    **table = (compl_word_T **)cws->cws_table.ga_data;
+    int		    lo = 0;
+    int		    hi = cws->cws_table.ga_len;
+    int		    mid;
+    int		    count = 0;
+
+    ++compl_words_wanted;
+    if (compl_length > 0)
+    {
+	// Find the first word that is not before the text, ignoring case.
+	while (lo < hi)
+	{
+	    mid = (lo + hi) / 2;
+	    if (MB_STRNICMP(table[mid]->cw_word, compl_orig_text,
+							    compl_length) < 0)
+		lo = mid + 1;
+	    else
+		hi = mid;
+	}
+    }
+    for ( ; lo < cws->cws_table.ga_len; ++lo)
+    {
+	if (compl_length > 0 && MB_STRNICMP(table[lo]->cw_word,
+					 compl_orig_text, compl_length) != 0)
+	    break;
+	if (table[lo]->cw_count > 0 && (ic || compl_length == 0
+		   || STRNCMP(table[lo]->cw_word, compl_orig_text,
+							  compl_length) == 0))
+	{
+	    table[lo]->cw_wanted = compl_words_wanted;
+	    ++count;
+	}
+    }
+    return count;
+}
+
+/*
+ * Update the word index of "buf" for a change in lines "lnum" to "lnume"
+ * (exclusive), with "xtra" lines inserted (deleted if negative).  The words
+ * of the changed lines are dropped, the lines are indexed again when used.
+ */
+    void
+ins_compl_words_changed(
+    buf_T	*buf,
+    linenr_T	lnum,
+    linenr_T	lnume,
+    long	xtra)
+{
+    garray_T	*gap;
+    char_u	**lines;
+    long	top = lnum > 0 ? lnum - 1 : 0;
+    long	old_bot = lnume - 1;
+    long	new_bot = lnume - 1 + xtra;
+    long	i;
+
+    if (buf->b_compl_words == NULL)
+	return;
+    gap = &buf->b_compl_words->cws_lines;
+    if (gap->ga_len + xtra != buf->b_ml.ml_line_count
+	    || old_bot > gap->ga_len || old_bot < top || new_bot < top
+	    || (xtra > 0 && ga_grow(gap, (int)xtra) == FAIL))
+    {
+	// Not a change we can follow (e.g. the buffer became empty), start
+	// all over when the index is used again.
+	ins_compl_words_free(buf);
+	return;
+    }
+
+    lines = (char_u **)gap->ga_data;
+    for (i = top; i < old_bot; ++i)
+    {
+	if (lines[i] == NULL)
+	    --buf->b_compl_words->cws_unindexed;
+	else
+	{
+	    compl_words_count(buf->b_compl_words, lines[i], -1);
+	    compl_words_free_line(lines[i]);
+	}
+    }
+    if (xtra != 0)
+	mch_memmove(lines + new_bot, lines + old_bot,
+			       (size_t)(gap->ga_len - old_bot) * sizeof(char_u *));
+    gap->ga_len += xtra;
+    for (i = top; i < new_bot; ++i)
+	lines[i] = NULL;
+    buf->b_compl_words->cws_unindexed += new_bot - top;
+}
+
+/*
+ * Free the word index of "buf".
+ */
+    void
+ins_compl_words_free(buf_T *buf)
+{
+    garray_T	*gap;
+    int		i;
+
+    if (buf->b_compl_words == NULL)
+	return;
+    gap = &buf->b_compl_words->cws_lines;
+    for (i = 0; i < gap->ga_len; ++i)
+	compl_words_free_line(((char_u **)gap->ga_data)[i]);
+    ga_clear(gap);
+    gap = &buf->b_compl_words->cws_table;
+    for (i = 0; i < gap->ga_len; ++i)
+	vim_free(((compl_word_T **)gap->ga_data)[i]);
+    ga_clear(gap);
+    vim_free(buf->b_compl_words->cws_isk);
+    VIM_CLEAR(buf->b_compl_words);
+}
+
+/*
+ * Add the words from the word index of "buf" that match the completion
+ * pattern, in the order the search would find them.  The index is created
+ * when needed.
+ * Only works for the "\<\k\k" and "\<text" patterns of ^N/^P, and when
+ * "buf" uses the same 'iskeyword' as the current buffer.
+ * Returns OK when a match was added, NOTDONE when there are no new matches
+ * and FAIL when the index can't be used.
+ */
+    static int
+ins_compl_buf_words(buf_T *buf)
+{
+    compl_words_T   *cws;
+    garray_T	    ga;
+    char_u	    *words;
+    char_u	    *w;
+    linenr_T	    lnum;
+    linenr_T	    n;
+    int		    len;
+    int		    ic;
+    int		    i;
+    int		    wanted;
+    int		    ret = NOTDONE;
+
+    // Quickfix and terminal buffers are changed without changed_lines().
+    if (buf->b_ml.ml_mfp == NULL || STRCMP(buf->b_p_isk, curbuf->b_p_isk) != 0
+#ifdef FEAT_QUICKFIX
+	    || bt_quickfix(buf)
+#endif
+#ifdef FEAT_TERMINAL
+	    || bt_terminal(buf)
+#endif
+	    )
+	return FAIL;
+    cws = buf->b_compl_words;
+    if (cws != NULL && (STRCMP(cws->cws_isk, buf->b_p_isk) != 0
+		       || cws->cws_lines.ga_len != buf->b_ml.ml_line_count))
+    {
+	// 'iskeyword' was changed, the words are different now
+	ins_compl_words_free(buf);
+	cws = NULL;
+    }
+    if (cws == NULL)
+    {
+	cws = (compl_words_T *)alloc_clear(sizeof(compl_words_T));
+	if (cws == NULL)
+	    return FAIL;
+	ga_init2(&cws->cws_lines, (int)sizeof(char_u *), 100);
+	ga_init2(&cws->cws_table, (int)sizeof(compl_word_T *), 100);
+	cws->cws_isk = vim_strsave(buf->b_p_isk);
+	if (cws->cws_isk == NULL
+		|| ga_grow(&cws->cws_lines, buf->b_ml.ml_line_count) == FAIL)
+	{
+	    vim_free(cws->cws_isk);
+	    vim_free(cws);
+	    return FAIL;
+	}
+	cws->cws_lines.ga_len = buf->b_ml.ml_line_count;
+	cws->cws_unindexed = buf->b_ml.ml_line_count;
+	buf->b_compl_words = cws;
+    }
+    cws->cws_used = compl_search_count;
+    if (compl_words_update(buf) == FAIL)
+	return FAIL;
+    if (got_int)
+	return NOTDONE;
+
+    // Use the same rules for ignoring case as searchit() would.
+    ic = ignorecase(compl_pattern);
+
+    // The table tells which words match, the lines only need to be looked
+    // at until all of them have been found.
+    wanted = compl_words_mark(cws, ic);
+    if (wanted == 0)
+	return NOTDONE;
+    ga_init2(&ga, (int)sizeof(char_u *), 20);
+
+    // Like searching from the start of the buffer, or backwards from the end
+    // for ^P.
+    for (n = 0; n < buf->b_ml.ml_line_count && wanted > 0
+						 && !compl_interrupted; ++n)
+    {
+	lnum = compl_direction == FORWARD ? n + 1
+					      : buf->b_ml.ml_line_count - n;
+	words = compl_words_get(buf, lnum);
+	ga.ga_len = 0;
+	for (w = words; *w != NUL; w += len + 1)
+	{
+	    len = (int)STRLEN(w);
+	    if ((compl_length == 0 || (ic
+			? MB_STRNICMP(w, compl_orig_text, compl_length)
+			: STRNCMP(w, compl_orig_text, compl_length)) == 0)
+		    && ga_grow(&ga, 1) == OK)
+	    {
+		compl_word_T *cw = compl_word_lookup(cws, w);
+
+		((char_u **)ga.ga_data)[ga.ga_len++] = w;
+		if (cw != NULL && cw->cw_wanted == compl_words_wanted)
+		{
+		    cw->cw_wanted = 0;
+		    --wanted;
+		}
+	    }
+	}
+	for (i = 0; i < ga.ga_len; ++i)
+	{
+	    w = ((char_u **)ga.ga_data)[compl_direction == FORWARD
+						    ? i : ga.ga_len - i - 1];
+	    if (ins_compl_add_infercase(w, (int)STRLEN(w), p_ic,
+					  buf->b_sfname, 0, FALSE) == OK)
+		ret = OK;
+	}
+	line_breakcheck();
+	if (got_int)
+	    break;
+    }
+    ga_clear(&ga);
+    return ret;
+}
+
 /*
  * Get the next expansion(s), using "compl_pattern".
  * The search starts at position "ini" in curbuf and in the direction
@@ -2481,11 +3052,34 @@ ins_compl_get_exp(pos_T *ini)
     char_u	*dict = NULL;
     int		dict_f = 0;
     int		set_match_pos;
+#ifdef FEAT_RELTIME
+    proftime_T	tm;
+    int		use_slice = FALSE;
+
+    // Only use a time slice for the sources of 'complete' and when the user
+    // is typing, not for keys from a script, :normal or feedkeys().
+    compl_search_more = FALSE;
+    compl_key_typed = FALSE;
+    if ((ctrl_x_mode == CTRL_X_NORMAL || ctrl_x_mode_line_or_eval())
+	    && KeyTyped && !using_script() && !ex_normal_busy)
+    {
+	profile_setlimit(COMPL_SEARCH_SLICE, &tm);
+	use_slice = TRUE;
+    }
+#endif
 
     if (!compl_started)
     {
+	// Free the word index of buffers that the previous completion did not
+	// use.
+	++compl_search_count;
 	FOR_ALL_BUFFERS(ins_buf)
+	{
 	    ins_buf->b_scanned = 0;
+	    if (ins_buf->b_compl_words != NULL
+		 && ins_buf->b_compl_words->cws_used < compl_search_count - 1)
+		ins_compl_words_free(ins_buf);
+	}
 	found_all = FALSE;
 	ins_buf = curbuf;
 	e_cpt = (compl_cont_status & CONT_LOCAL)
@@ -2715,6 +3309,18 @@ ins_compl_get_exp(pos_T *ini)
 	    {
 		int	cont_s_ipos = FALSE;
 
+		// For other buffers use the word index, all matches are added
+		// at once.
+		if (ins_buf != curbuf && ctrl_x_mode == CTRL_X_NORMAL
+			&& !(compl_cont_status & (CONT_ADDING | CONT_SOL))
+			&& (i = ins_compl_buf_words(ins_buf)) != FAIL)
+		{
+		    found_new_match = i == OK ? OK : FAIL;
+		    ins_buf->b_scanned = TRUE;
+		    found_all = TRUE;
+		    break;
+		}
+
 		++msg_silent;  // Don't want messages for wrapscan.
 
 		// ctrl_x_mode_line_or_eval() || word-wise search that
@@ -2861,6 +3467,16 @@ ins_compl_get_exp(pos_T *ini)
 			&& !ctrl_x_mode_line_or_eval()) || compl_interrupted)
 		break;
 	    compl_started = TRUE;
+#ifdef FEAT_RELTIME
+	    // Continue with this entry later when out of time or when a key
+	    // was typed.
+	    if (use_slice && (compl_key_typed || profile_passed_limit(&tm)))
+	    {
+		compl_search_more = TRUE;
+		compl_search_dir = compl_direction;
+		break;
+	    }
+#endif
 	}
 	else
 	{
@@ -2869,6 +3485,18 @@ ins_compl_get_exp(pos_T *ini)
 		ins_buf->b_scanned = TRUE;
 
 	    compl_started = FALSE;
+#ifdef FEAT_RELTIME
+	    // Continue with the next entry later when out of time or when a
+	    // key was typed.
+	    if (use_slice && *e_cpt != NUL
+			   && (compl_key_typed || profile_passed_limit(&tm)))
+	    {
+		found_all = TRUE;
+		compl_search_more = TRUE;
+		compl_search_dir = compl_direction;
+		break;
+	    }
+#endif
 	}
     }
     compl_started = TRUE;
@@ -2878,7 +3506,11 @@ ins_compl_get_exp(pos_T *ini)
 	found_new_match = FAIL;
 
     i = -1;		// total of matches, unknown
-    if (found_new_match == FAIL || (ctrl_x_mode != CTRL_X_NORMAL
+    if ((found_new_match == FAIL
+#ifdef FEAT_RELTIME
+		&& !compl_search_more
+#endif
+		) || (ctrl_x_mode != CTRL_X_NORMAL
 					       && !ctrl_x_mode_line_or_eval()))
 	i = ins_compl_make_cyclic();
 
@@ -3234,6 +3866,17 @@ ins_compl_check_keys(int frequency, int in_compl_func)
 	return;
     count = 0;
 
+#ifdef FEAT_RELTIME
+    // When searching for more matches only stop searching, edit() gets the
+    // key.  Selecting a match here would insert it halfway the search.
+    if (compl_searching_more)
+    {
+	if (char_avail())
+	    compl_key_typed = TRUE;
+	return;
+    }
+#endif
+
     // Check for a typed key.  Do use mappings, otherwise vim_is_ctrl_x_key()
     // can't do its work correctly.
     c = vpeekc_any();
@@ -3271,6 +3914,77 @@ ins_compl_check_keys(int frequency, int in_compl_func)
     }
 }
 
+/*
+ * Called in Insert mode before waiting for a key: when searching for matches
+ * was stopped to keep typing responsive, continue finding matches one time
+ * slice at a time until a key is typed, and update the popup menu with them.
+ */
+    void
+ins_compl_search_more(void)
+{
+#ifdef FEAT_RELTIME
+    compl_T	*match;
+    int		n;
+    int		number;
+    int		save_direction;
+
+    while (compl_search_more && compl_started && compl_first_match != NULL
+							     && !char_avail())
+    {
+	// Continue searching in the same direction, new matches are added
+	// after the last one in that direction.
+	save_direction = compl_direction;
+	compl_direction = compl_search_dir;
+	match = compl_first_match;
+	if (compl_direction == FORWARD)
+	    while (match->cp_next != NULL && match->cp_next != compl_first_match)
+		match = match->cp_next;
+	else
+	    while (match->cp_prev != NULL && match->cp_prev != compl_first_match)
+		match = match->cp_prev;
+	compl_curr_match = match;
+
+	compl_searching_more = TRUE;
+	n = ins_compl_get_exp(&compl_startpos);
+	compl_searching_more = FALSE;
+	if (n > 1)		// all matches have been found
+	    compl_matches = n;
+
+	// Number the new matches, otherwise they get the wrong number when
+	// reached from the other end of the list.
+	number = 0;
+	match = compl_first_match;
+	for (;;)
+	{
+	    match = compl_direction == FORWARD ? match->cp_next : match->cp_prev;
+	    if (match == NULL || match == compl_first_match)
+		break;
+	    if (match->cp_number == -1)
+		match->cp_number = number + 1;
+	    number = match->cp_number;
+	}
+
+	compl_direction = save_direction;
+	compl_curr_match = compl_shown_match;
+
+	if (compl_interrupted)
+	{
+	    compl_was_interrupted = TRUE;
+	    compl_interrupted = FALSE;
+	    break;
+	}
+	if (got_int)
+	    break;
+
+	if (pum_wanted() && pum_enough_matches())
+	    show_pum(curwin->w_wrow, curwin->w_leftcol);
+	else
+	    ins_compl_upd_pum();
+	out_flush();
+    }
+#endif
+}
+
 /*
  * Decide the direction of Insert mode complete from the key typed.
  * Returns BACKWARD or FORWARD.
@@ -267,6 +267,11 @@ typedef struct {
   int (*bell)(void *user);
   int (*resize)(int rows, int cols, VTermPos *delta, void *user);
   int (*setlineinfo)(int row, const VTermLineInfo *newinfo, const VTermLineInfo *oldinfo, void *user);
+  /* Optional: put "count" glyphs starting at "pos", each one of the
+   * codepoints in "chars[]" with a width of one.  "info->chars" and
+   * "info->width" are not used.  When not set or when it returns 0 putglyph
+   * is used for each glyph. */
+  int (*putglyphs)(const uint32_t chars[], int count, VTermGlyphInfo *info, VTermPos pos, void *user);
 } VTermStateCallbacks;
 
 typedef struct {
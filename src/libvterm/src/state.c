@@ -29,6 +29,46 @@ static void putglyph(VTermState *state, const uint32_t chars[], int width, VTerm
   DEBUG_LOG3("libvterm: Unhandled putglyph U+%04x at (%d,%d)\n", chars[0], pos.col, pos.row);
 }
 
+/*
+ * Put "count" glyphs of width one, one codepoint each, starting at "pos".
+ * Return 0 when the callback does not handle this, putglyph() must be used.
+ */
+static int putglyphs(VTermState *state, const uint32_t chars[], int count, VTermPos pos)
+{
+  VTermGlyphInfo info;
+
+  if(!state->callbacks || !state->callbacks->putglyphs)
+    return 0;
+
+  info.chars = NULL;
+  info.width = 1;
+  info.protected_cell = state->protected_cell;
+  info.dwl = state->lineinfo[pos.row].doublewidth;
+  info.dhl = state->lineinfo[pos.row].doubleheight;
+
+  return (*state->callbacks->putglyphs)(chars, count, &info, pos, state->cbdata);
+}
+
+/*
+ * Return the number of plain printable ASCII characters at "codepoints[i]"
+ * that can be put in the current row as a run.  The last codepoint is never
+ * included, it may be combined with what follows in the next call.
+ */
+static int printable_run(VTermState *state, const uint32_t codepoints[], int i, int npoints)
+{
+  int end = i;
+  int max = THISROWWIDTH(state) - state->pos.col;
+
+  while(end < npoints - 1 && end - i < max
+      && codepoints[end] >= 0x20 && codepoints[end] < 0x7f)
+    end++;
+  /* A combining character belongs to the glyph before it */
+  if(end > i && end < npoints && vterm_unicode_is_combining(codepoints[end]))
+    end--;
+
+  return end - i;
+}
+
 static void updatecursor(VTermState *state, VTermPos *oldpos, int cancel_phantom)
 {
   if(state->pos.col == oldpos->col && state->pos.row == oldpos->row)
@@ -326,14 +366,36 @@ static int on_text(const char bytes[], size_t len, void *user)
     int glyph_ends;
     int width = 0;
     uint32_t *chars;
+    uint32_t chars_buf[VTERM_MAX_CHARS_PER_CELL + 1];
+
+    // Fast path for a run of plain ASCII that fits in the row.
+    if(!state->at_phantom && !state->mode.insert) {
+      int count = printable_run(state, codepoints, i, npoints);
+
+      if(count > 1 && putglyphs(state, codepoints + i, count, state->pos)) {
+        i += count - 1;
+        if(state->pos.col + count >= THISROWWIDTH(state)) {
+          state->pos.col = THISROWWIDTH(state) - 1;
+          if(state->mode.autowrap)
+            state->at_phantom = 1;
+        }
+        else
+          state->pos.col += count;
+        continue;
+      }
+    }
 
     for(glyph_ends = i + 1; glyph_ends < npoints; glyph_ends++)
       if(!vterm_unicode_is_combining(codepoints[glyph_ends]))
         break;
 
-    chars = vterm_allocator_malloc(state->vt, (glyph_ends - glyph_starts + 1) * sizeof(uint32_t));
-    if (chars == NULL)
-      break;
+    if(glyph_ends - glyph_starts < VTERM_MAX_CHARS_PER_CELL + 1)
+      chars = chars_buf;
+    else {
+      chars = vterm_allocator_malloc(state->vt, (glyph_ends - glyph_starts + 1) * sizeof(uint32_t));
+      if (chars == NULL)
+        break;
+    }
 
     for( ; i < glyph_ends; i++) {
       int this_width;
@@ -403,7 +465,8 @@ static int on_text(const char bytes[], size_t len, void *user)
     else {
       state->pos.col += width;
     }
-    vterm_allocator_free(state->vt, chars);
+    if(chars != chars_buf)
+      vterm_allocator_free(state->vt, chars);
   }
 
   updatecursor(state, &oldpos, 0);
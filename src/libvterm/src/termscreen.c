@@ -205,6 +205,48 @@ static int putglyph(VTermGlyphInfo *info, VTermPos pos, void *user)
   return 1;
 }
 
+/*
+ * Put a run of single-width glyphs of one codepoint each in one row.  Sets
+ * the cells directly and damages them at once.
+ */
+static int putglyphs(const uint32_t chars[], int count, VTermGlyphInfo *info, VTermPos pos, void *user)
+{
+  int i;
+  VTermRect rect;
+
+  VTermScreen *screen = user;
+  ScreenCell *cell = getcell(screen, pos.row, pos.col);
+
+  if(!cell || pos.col + count > screen->cols)
+    return 0;
+
+  for(i = 0; i < count; i++, cell++) {
+    cell->chars[0] = chars[i];
+    cell->chars[1] = 0;
+    cell->pen = screen->pen;
+    cell->pen.protected_cell = info->protected_cell;
+    cell->pen.dwl            = info->dwl;
+    cell->pen.dhl            = info->dhl;
+  }
+
+  rect.start_row = pos.row;
+  rect.end_row   = pos.row+1;
+  rect.start_col = pos.col;
+  rect.end_col   = pos.col+count;
+
+  if(screen->damage_merge == VTERM_DAMAGE_CELL)
+    /* Damage is emitted for each cell */
+    for(i = 0; i < count; i++) {
+      rect.start_col = pos.col+i;
+      rect.end_col   = pos.col+i+1;
+      damagerect(screen, rect);
+    }
+  else
+    damagerect(screen, rect);
+
+  return 1;
+}
+
 static int moverect_internal(VTermRect dest, VTermRect src, void *user)
 {
   VTermScreen *screen = user;
@@ -617,7 +659,8 @@ static VTermStateCallbacks state_cbs = {
   &settermprop, /* settermprop */
   &bell, /* bell */
   &resize, /* resize */
-  &setlineinfo /* setlineinfo */
+  &setlineinfo, /* setlineinfo */
+  &putglyphs /* putglyphs */
 };
 
 /*
@@ -202,7 +202,9 @@
 #endif
 
 #ifdef STARTUPTIME
-# define TIME_MSG(s) do { if (time_fd != NULL) time_msg(s, NULL); } while (0)
+# define TIME_MSG(s) do { \
+	if (time_fd != NULL) time_msg(s, NULL); \
+	if (trace_fd != NULL) trace_msg(s); } while (0)
 #else
 # define TIME_MSG(s) do { /**/ } while (0)
 #endif
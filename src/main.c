@@ -150,14 +150,14 @@ main
 #endif
 
 #ifdef STARTUPTIME
-    /* Need to find "--startuptime" before actually parsing arguments. */
+    /* Need to find "--startuptime" and "--startuptrace" before actually
+     * parsing arguments. */
     for (i = 1; i < argc - 1; ++i)
-	if (STRICMP(argv[i], "--startuptime") == 0)
-	{
+	if (STRICMP(argv[i], "--startuptime") == 0 && time_fd == NULL)
 	    time_fd = mch_fopen(argv[i + 1], "a");
-	    TIME_MSG("--- VIM STARTING ---");
-	    break;
-	}
+	else if (STRICMP(argv[i], "--startuptrace") == 0 && trace_fd == NULL)
+	    trace_open(argv[i + 1]);
+    TIME_MSG("--- VIM STARTING ---");
 #endif
     starttime = time(NULL);
 
@@ -1307,12 +1307,16 @@ main_loop(
 #ifdef STARTUPTIME
 	    /* Now that we have drawn the first screen all the startup stuff
 	     * has been done, close any file for startup messages. */
-	    if (time_fd != NULL)
+	    if (time_fd != NULL || trace_fd != NULL)
 	    {
 		TIME_MSG("first screen update");
 		TIME_MSG("--- VIM STARTED ---");
-		fclose(time_fd);
-		time_fd = NULL;
+		if (time_fd != NULL)
+		{
+		    fclose(time_fd);
+		    time_fd = NULL;
+		}
+		trace_close();
 	    }
 #endif
 	}
@@ -1406,6 +1410,10 @@ getout(int exitval)
 #if defined(FEAT_JOB_CHANNEL)
     ch_log(NULL, "Exiting...");
 #endif
+#ifdef STARTUPTIME
+    // When exiting before the first screen update still finish the trace.
+    trace_close();
+#endif
 
     /* When running in Ex mode an error causes us to exit with a non-zero exit
      * code.  POSIX requires this, although it's not 100% clear from the
@@ -1947,6 +1955,11 @@ command_line_scan(mparm_T *parmp)
 		    want_argument = TRUE;
 		    argv_idx += 11;
 		}
+		else if (STRNICMP(argv[0] + argv_idx, "startuptrace", 12) == 0)
+		{
+		    want_argument = TRUE;
+		    argv_idx += 12;
+		}
 #ifdef FEAT_CLIENTSERVER
 		else if (STRNICMP(argv[0] + argv_idx, "serverlist", 10) == 0)
 		    ; /* already processed -- no arg */
@@ -2328,7 +2341,8 @@ command_line_scan(mparm_T *parmp)
 			parmp->pre_commands[parmp->n_pre_commands++] =
 							    (char_u *)argv[0];
 		    }
-		    /* "--startuptime <file>" already handled */
+		    /* "--startuptime <file>" and "--startuptrace <file>"
+		     * already handled */
 		    break;
 
 	    /*	case 'd':   -d {device} is handled in mch_check_win() for the
@@ -3417,6 +3431,7 @@ usage(void)
 #endif
 #ifdef STARTUPTIME
     main_msg(_("--startuptime <file>\tWrite startup timing messages to <file>"));
+    main_msg(_("--startuptrace <file>\tWrite a startup trace in JSON to <file>"));
 #endif
 #ifdef FEAT_VIMINFO
     main_msg(_("-i <viminfo>\t\tUse <viminfo> instead of .viminfo"));
@@ -3603,6 +3618,181 @@ time_msg(
     }
 }
 
+/*
+ * For "--startuptrace": a span of time in the trace that can contain nested
+ * spans.
+ */
+typedef struct {
+    char	    *ts_cat;	    // category, e.g. "plugin"
+    char_u	    *ts_name;	    // allocated
+    struct timeval  ts_start;
+    long	    ts_child_usec;  // time spent in nested spans
+    long_u	    ts_allocs;	    // alloc_count at the start
+} trace_span_T;
+
+static garray_T		trace_spans = {0, 0, sizeof(trace_span_T), 10, NULL};
+static struct timeval	trace_start;
+static int		trace_event_count = 0;
+
+    static long
+trace_usec(struct timeval *then, struct timeval *now)
+{
+    return (now->tv_sec - then->tv_sec) * 1000000L
+					     + (now->tv_usec - then->tv_usec);
+}
+
+/*
+ * Write "str" to the trace file as a JSON string.
+ */
+    static void
+trace_put_string(char_u *str)
+{
+    char_u	*p;
+    int		len;
+    int		c;
+
+    putc('"', trace_fd);
+    for (p = str; *p != NUL; ++p)
+    {
+	if (*p == '"' || *p == '\\')
+	    fprintf(trace_fd, "\\%c", *p);
+	else if (*p < ' ')
+	    fprintf(trace_fd, "\\u%04x", *p);
+	else if (*p < 0x80)
+	    putc(*p, trace_fd);
+	else
+	{
+	    // JSON must be valid UTF-8.  A byte that doesn't start a valid
+	    // UTF-8 sequence, e.g. in a latin1 file name, is taken as a
+	    // latin1 character.
+	    len = utf_ptr2len(p);
+	    c = utf_ptr2char(p);
+	    if (len > 1 && utf_char2len(c) == len
+				     && (c < 0xd800 || c > 0xdfff) && c <= 0x10ffff)
+	    {
+		fwrite(p, (size_t)len, (size_t)1, trace_fd);
+		p += len - 1;
+	    }
+	    else
+		fprintf(trace_fd, "\\u%04x", *p);
+	}
+    }
+    putc('"', trace_fd);
+}
+
+/*
+ * Start writing the event for "name" with category "cat" and phase "ph" to
+ * the trace file, up to the timestamp.
+ */
+    static void
+trace_put_event(char *ph, char *cat, char_u *name, long ts)
+{
+    fputs(trace_event_count++ == 0 ? "\n" : ",\n", trace_fd);
+    fputs("{\"name\":", trace_fd);
+    trace_put_string(name);
+    fprintf(trace_fd, ",\"cat\":\"%s\",\"ph\":\"%s\",\"pid\":%ld,\"tid\":1,\"ts\":%ld",
+					   cat, ph, (long)mch_get_pid(), ts);
+}
+
+/*
+ * Open "fname" for "--startuptrace" and write the start of the trace.  The
+ * trace uses the Chrome trace event format.
+ */
+    void
+trace_open(char *fname)
+{
+    trace_fd = mch_fopen(fname, "w");
+    if (trace_fd == NULL)
+	return;
+    gettimeofday(&trace_start, NULL);
+    fputs("{\"traceEvents\":[", trace_fd);
+    trace_put_event("M", "__metadata", (char_u *)"process_name", 0);
+    fputs(",\"args\":{\"name\":\"vim\"}}", trace_fd);
+}
+
+/*
+ * Begin a span for "name" in category "cat" in the trace.  Must be followed
+ * by a call to trace_end().
+ */
+    void
+trace_begin(char *cat, char_u *name)
+{
+    trace_span_T    *span;
+
+    if (trace_fd == NULL || ga_grow(&trace_spans, 1) == FAIL)
+	return;
+    span = (trace_span_T *)trace_spans.ga_data + trace_spans.ga_len;
+    span->ts_cat = cat;
+    span->ts_name = vim_strsave(name);
+    span->ts_child_usec = 0;
+    gettimeofday(&span->ts_start, NULL);
+    span->ts_allocs = alloc_count;
+    ++trace_spans.ga_len;
+}
+
+/*
+ * End the span started with the last call to trace_begin() and write it to
+ * the trace.  The time spent in nested spans is subtracted for the "self"
+ * time.
+ */
+    void
+trace_end(void)
+{
+    trace_span_T    *span;
+    struct timeval  now;
+    long	    dur;
+
+    if (trace_spans.ga_len == 0)
+	return;
+    span = (trace_span_T *)trace_spans.ga_data + --trace_spans.ga_len;
+    gettimeofday(&now, NULL);
+    dur = trace_usec(&span->ts_start, &now);
+    if (trace_fd != NULL && span->ts_name != NULL)
+    {
+	trace_put_event("X", span->ts_cat, span->ts_name,
+				      trace_usec(&trace_start, &span->ts_start));
+	fprintf(trace_fd, ",\"dur\":%ld,\"args\":{\"self_us\":%ld,\"allocs\":%lu}}",
+		dur, dur - span->ts_child_usec,
+		(unsigned long)(alloc_count - span->ts_allocs));
+    }
+    vim_free(span->ts_name);
+    if (trace_spans.ga_len > 0)
+	((trace_span_T *)trace_spans.ga_data + trace_spans.ga_len - 1)
+						      ->ts_child_usec += dur;
+}
+
+/*
+ * Put a message in the trace, like time_msg() does for "--startuptime".
+ */
+    void
+trace_msg(char *mesg)
+{
+    struct timeval  now;
+
+    if (trace_fd == NULL)
+	return;
+    gettimeofday(&now, NULL);
+    trace_put_event("i", "startup", (char_u *)mesg,
+					      trace_usec(&trace_start, &now));
+    fputs(",\"s\":\"g\"}", trace_fd);
+}
+
+/*
+ * Finish the trace: end any spans that are still open and close the file.
+ */
+    void
+trace_close(void)
+{
+    if (trace_fd == NULL)
+	return;
+    while (trace_spans.ga_len > 0)
+	trace_end();
+    ga_clear(&trace_spans);
+    fputs("\n]}\n", trace_fd);
+    fclose(trace_fd);
+    trace_fd = NULL;
+}
+
 #endif
 
 #if !defined(NO_VIM_MAIN) && defined(FEAT_EVAL)
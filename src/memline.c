@@ -848,6 +848,15 @@ ml_close(buf_T *buf, int del_file)
     vim_free(buf->b_ml.ml_stack);
 #ifdef FEAT_BYTEOFF
     VIM_CLEAR(buf->b_ml.ml_chunksize);
+#endif
+#ifdef FEAT_TEXT_PROP
+    prop_index_clear(buf);
+#endif
+#ifdef FEAT_INS_EXPAND
+    ins_compl_words_free(buf);
+#endif
+#ifdef FEAT_SPELL
+    spell_cache_clear_buf(buf);
 #endif
     buf->b_ml.ml_mfp = NULL;
 
@@ -3277,6 +3286,17 @@ ml_append_int(
 #ifdef FEAT_JOB_CHANNEL
     if (buf->b_write_to_channel)
 	channel_write_new_lines(buf);
+#endif
+#ifdef FEAT_TEXT_PROP
+    if (buf->b_has_textprop)
+    {
+	size_t textlen = STRLEN(line) + 1;
+
+	prop_index_adjust(buf, lnum, 1L);
+	if ((size_t)len > textlen)
+	    prop_index_add_line(buf, lnum + 1, line + textlen,
+				 (int)((len - textlen) / sizeof(textprop_T)));
+    }
 #endif
     ret = OK;
 
@@ -3390,6 +3410,14 @@ ml_replace_len(
 	    }
 	}
     }
+    else if (has_props && curbuf->b_has_textprop)
+    {
+	size_t	textlen = STRLEN(line) + 1;
+
+	if ((size_t)len > textlen)
+	    prop_index_add_line(curbuf, lnum, line + textlen,
+				 (int)((len - textlen) / sizeof(textprop_T)));
+    }
 #endif
 
     if (curbuf->b_ml.ml_flags & ML_LINE_DIRTY)	// same line allocated
@@ -3403,6 +3431,151 @@ ml_replace_len(
     return OK;
 }
 
+/*
+ * Replace "count" lines starting at "lnum" in the current buffer with the
+ * allocated strings in "lines[]", which are taken over.  A NULL entry keeps
+ * the line.  The text in each data block is rewritten once, while
+ * ml_replace() moves the text of the following lines for every line.
+ * Used by ":s" to change many lines.
+ */
+    void
+ml_replace_lines(linenr_T lnum, long count, char_u **lines)
+{
+    buf_T	*buf = curbuf;
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    long	done;
+    long	n;
+    long	i;
+    int		idx;
+    int		first_idx;
+    int		line_count;
+    int		start;
+    int		end;
+    int		prev_start;
+    int		old_start;
+    int		len;
+    int		extra;
+    char_u	*text;
+    char_u	*p;
+
+    // The buffered line goes into its data block first.
+    ml_flush_line(buf);
+
+    for (done = 0; done < count; done += n)
+    {
+	n = 1;
+	if (lines[done] == NULL)
+	    continue;
+
+	hp = NULL;
+	if (
+#ifdef FEAT_NETBEANS_INTG
+		!netbeans_active() &&
+#endif
+#ifdef FEAT_TEXT_PROP
+		!buf->b_has_textprop &&
+#endif
+		buf->b_ml.ml_mfp != NULL)
+	    hp = ml_find_line(buf, lnum + done, ML_FIND);
+	if (hp == NULL)
+	{
+	    // Do it the slow way.
+	    if (ml_replace(lnum + done, lines[done], FALSE) == FAIL)
+		vim_free(lines[done]);
+	    continue;
+	}
+	dp = (DATA_BL *)(hp->bh_data);
+	line_count = buf->b_ml.ml_locked_high - buf->b_ml.ml_locked_low + 1;
+	first_idx = lnum + done - buf->b_ml.ml_locked_low;
+	n = line_count - first_idx;
+	if (n > count - done)
+	    n = count - done;
+
+	// The text of the lines is stored from the end of the block, thus
+	// "start" is where the last line starts and "end" where the first line
+	// ends.
+	start = dp->db_index[first_idx + n - 1] & DB_INDEX_MASK;
+	end = first_idx == 0 ? (int)dp->db_txt_end
+			 : (int)(dp->db_index[first_idx - 1] & DB_INDEX_MASK);
+	extra = -(end - start);
+	for (i = 0; i < n; ++i)
+	{
+	    idx = first_idx + i;
+	    if (lines[done + i] != NULL)
+		extra += (int)STRLEN(lines[done + i]) + 1;
+	    else
+		extra += (idx == 0 ? (int)dp->db_txt_end
+			       : (int)(dp->db_index[idx - 1] & DB_INDEX_MASK))
+				   - (int)(dp->db_index[idx] & DB_INDEX_MASK);
+	}
+
+	text = NULL;
+	if ((int)dp->db_free >= extra)
+	    text = alloc(end - start + extra);
+	if (text == NULL)
+	{
+	    // Does not fit in the data block, do it the slow way.
+	    for (i = 0; i < n; ++i)
+		if (lines[done + i] != NULL)
+		{
+		    if (ml_replace(lnum + done + i, lines[done + i], FALSE)
+								       == FAIL)
+			vim_free(lines[done + i]);
+		    ml_flush_line(buf);
+		}
+	    continue;
+	}
+
+	// Put the new text of the lines in "text", the first line at the end.
+	p = text + end - start + extra;
+	prev_start = end;
+	for (i = 0; i < n; ++i)
+	{
+	    idx = first_idx + i;
+	    old_start = dp->db_index[idx] & DB_INDEX_MASK;
+	    if (lines[done + i] == NULL)
+	    {
+		len = prev_start - old_start;
+		p -= len;
+		mch_memmove(p, (char_u *)dp + old_start, (size_t)len);
+	    }
+	    else
+	    {
+		len = (int)STRLEN(lines[done + i]) + 1;
+		p -= len;
+		mch_memmove(p, lines[done + i], (size_t)len);
+#ifdef FEAT_BYTEOFF
+		ml_updatechunk(buf, lnum + done + i,
+			       (long)(len - (prev_start - old_start)),
+							      ML_CHNK_UPDLINE);
+#endif
+		vim_free(lines[done + i]);
+	    }
+	    prev_start = old_start;
+	    dp->db_index[idx] = (dp->db_index[idx] & ~DB_INDEX_MASK)
+					 + (start - extra) + (int)(p - text);
+	}
+
+	// Move the text of the following lines, then copy the new text.
+	if (extra != 0 && first_idx + n < line_count)
+	{
+	    mch_memmove((char *)dp + dp->db_txt_start - extra,
+			(char *)dp + dp->db_txt_start,
+			(size_t)(start - dp->db_txt_start));
+	    for (idx = first_idx + n; idx < line_count; ++idx)
+		dp->db_index[idx] -= extra;
+	}
+	mch_memmove((char *)dp + start - extra, text,
+					       (size_t)(end - start + extra));
+	vim_free(text);
+	dp->db_free -= extra;
+	dp->db_txt_start -= extra;
+	buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+    }
+    buf->b_ml.ml_flags &= ~ML_EMPTY;
+}
+
 #ifdef FEAT_TEXT_PROP
 /*
  * Adjust text properties in line "lnum" for a deleted line.
@@ -3695,6 +3868,10 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
 
 #ifdef FEAT_BYTEOFF
     ml_updatechunk(buf, lnum, line_size, ML_CHNK_DELLINE);
+#endif
+#ifdef FEAT_TEXT_PROP
+    if (buf->b_has_textprop)
+	prop_index_adjust(buf, lnum, -1L);
 #endif
     ret = OK;
 
@@ -5358,7 +5535,6 @@ ml_updatechunk(
     int		updtype)
 {
     static buf_T	*ml_upd_lastbuf = NULL;
-    static linenr_T	ml_upd_lastline;
     static linenr_T	ml_upd_lastcurline;
     static int		ml_upd_lastcurix;
 
@@ -5384,6 +5560,7 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
+	ml_upd_lastbuf = NULL;
     }
 
     if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
@@ -5394,29 +5571,25 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = (long)buf->b_ml.ml_line_len;
+	ml_upd_lastbuf = NULL;
 	return;
     }
 
     /*
      * Find chunk that our line belongs to, curline will be at start of the
-     * chunk.
+     * chunk.  When going forward start at the chunk found last time, this
+     * matters when changing many lines in a long buffer, e.g. with ":%s".
      */
-    if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
-	    || updtype != ML_CHNK_ADDLINE)
+    if (buf != ml_upd_lastbuf || line < curline
+				       || curix >= buf->b_ml.ml_usedchunks)
     {
-	for (curline = 1, curix = 0;
-	     curix < buf->b_ml.ml_usedchunks - 1
+	curline = 1;
+	curix = 0;
+    }
+    for ( ; curix < buf->b_ml.ml_usedchunks - 1
 	     && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines;
 	     curix++)
-	    curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-    }
-    else if (curix < buf->b_ml.ml_usedchunks - 1
-	      && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
-    {
-	/* Adjust cached curix & curline */
 	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	curix++;
-    }
     curchnk = buf->b_ml.ml_chunksize + curix;
 
     if (updtype == ML_CHNK_DELLINE)
@@ -5594,7 +5767,6 @@ ml_updatechunk(
 	return;
     }
     ml_upd_lastbuf = buf;
-    ml_upd_lastline = line;
     ml_upd_lastcurline = curline;
     ml_upd_lastcurix = curix;
 }
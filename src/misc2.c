@@ -907,6 +907,9 @@ lalloc(size_t size, int message)
 #ifdef MEM_PROFILE
     mem_pre_alloc_l(&size);
 #endif
+#ifdef STARTUPTIME
+    ++alloc_count;
+#endif
 
     /*
      * Loop when out of memory: Try to release some memfile blocks and
@@ -1121,6 +1124,10 @@ free_all_mem(void)
     free_regexp_stuff();
     free_tag_stuff();
     free_cd_dir();
+    clear_rtp_dirs();
+# ifdef FEAT_VIMINFO
+    free_viminfo_marks_index();
+# endif
 # ifdef FEAT_SIGNS
     free_signs();
 # endif
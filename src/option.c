@@ -2650,6 +2650,9 @@ static struct vimoption options[] =
 			    {(char_u *)TRUE, (char_u *)0L}
 #endif
 			    SCTX_INIT},
+    {"tagcache",    "tca",  P_NUM|P_VI_DEF,
+			    (char_u *)&p_tca, PV_NONE,
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"tagcase",	    "tc",   P_STRING|P_VIM,
 			    (char_u *)&p_tc, PV_TC,
 			    {(char_u *)"followic", (char_u *)"followic"} SCTX_INIT},
@@ -2662,6 +2665,13 @@ static struct vimoption options[] =
 			    {(char_u *)0L, (char_u *)0L}
 #endif
 			    SCTX_INIT},
+    {"tagindex",    "tgi",  P_BOOL|P_VI_DEF,
+#ifdef FEAT_TAG_BINS
+			    (char_u *)&p_tgi, PV_NONE,
+#else
+			    (char_u *)NULL, PV_NONE,
+#endif
+			    {(char_u *)FALSE, (char_u *)0L} SCTX_INIT},
     {"taglength",   "tl",   P_NUM|P_VI_DEF,
 			    (char_u *)&p_tl, PV_NONE,
 			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
@@ -2746,6 +2756,15 @@ static struct vimoption options[] =
 #else
 			    (char_u *)NULL, PV_NONE,
 			    {(char_u *)NULL, (char_u *)0L}
+#endif
+			    SCTX_INIT},
+    {"termwinupdate", "twu", P_NUM|P_VI_DEF,
+#if defined(FEAT_TERMINAL) && defined(FEAT_TIMERS)
+			    (char_u *)&p_twu, PV_NONE,
+			    {(char_u *)20L, (char_u *)0L}
+#else
+			    (char_u *)NULL, PV_NONE,
+			    {(char_u *)NULL, (char_u *)0L}
 #endif
 			    SCTX_INIT},
     {"terse",	    NULL,   P_BOOL|P_VI_DEF,
@@ -2883,6 +2902,9 @@ static struct vimoption options[] =
 			    (char_u *)100L,
 #endif
 				(char_u *)0L} SCTX_INIT},
+    {"undomaxmem",  "umm",  P_NUM|P_VI_DEF,
+			    (char_u *)&p_umm, PV_NONE,
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"undoreload",  "ur",   P_NUM|P_VI_DEF,
 			    (char_u *)&p_ur, PV_NONE,
 			    { (char_u *)10000L, (char_u *)0L} SCTX_INIT},
@@ -3265,6 +3287,10 @@ static void set_option_sctx_idx(int opt_idx, int opt_flags, sctx_T script_ctx);
 #endif
 static char *set_bool_option(int opt_idx, char_u *varp, int value, int opt_flags);
 static char *set_num_option(int opt_idx, char_u *varp, long value, char *errbuf, size_t errbuflen, int opt_flags);
+#ifdef STARTUPTIME
+static void trace_option_begin(int opt_idx);
+static void trace_option_end(void);
+#endif
 static void check_redraw(long_u flags);
 static int findoption(char_u *);
 static int find_key_option(char_u *arg_arg, int has_lt);
@@ -4781,8 +4807,14 @@ do_set(
 			    value = prefix;
 		    }
 
+#ifdef STARTUPTIME
+		    trace_option_begin(opt_idx);
+#endif
 		    errmsg = set_bool_option(opt_idx, varp, (int)value,
 								   opt_flags);
+#ifdef STARTUPTIME
+		    trace_option_end();
+#endif
 		}
 		else				    /* numeric or string */
 		{
@@ -4860,8 +4892,14 @@ do_set(
 			    value = *(long *)varp * value;
 			if (removing)
 			    value = *(long *)varp - value;
+#ifdef STARTUPTIME
+			trace_option_begin(opt_idx);
+#endif
 			errmsg = set_num_option(opt_idx, varp, value,
 					   errbuf, sizeof(errbuf), opt_flags);
+#ifdef STARTUPTIME
+			trace_option_end();
+#endif
 		    }
 		    else if (opt_idx >= 0)		    /* string */
 		    {
@@ -5285,10 +5323,16 @@ do_set(
 			    // for ":set" on local options. Note: when setting
 			    // 'syntax' or 'filetype' autocommands may be
 			    // triggered that can cause havoc.
+#ifdef STARTUPTIME
+			    trace_option_begin(opt_idx);
+#endif
 			    errmsg = did_set_string_option(
 				    opt_idx, (char_u **)varp,
 				    new_value_alloced, oldval, errbuf,
 				    opt_flags, &value_checked);
+#ifdef STARTUPTIME
+			    trace_option_end();
+#endif
 
 			    secure = secure_saved;
 			}
@@ -6184,8 +6228,15 @@ set_string_option(
 	    saved_newval = vim_strsave(s);
 	}
 #endif
-	if ((r = did_set_string_option(opt_idx, varp, TRUE, oldval, NULL,
-					   opt_flags, &value_checked)) == NULL)
+#ifdef STARTUPTIME
+	trace_option_begin(opt_idx);
+#endif
+	r = did_set_string_option(opt_idx, varp, TRUE, oldval, NULL,
+						   opt_flags, &value_checked);
+#ifdef STARTUPTIME
+	trace_option_end();
+#endif
+	if (r == NULL)
 	    did_set_option(opt_idx, opt_flags, TRUE, value_checked);
 
 #if defined(FEAT_EVAL)
@@ -6253,6 +6304,26 @@ valid_spellfile(char_u *val)
 }
 #endif
 
+#ifdef STARTUPTIME
+/*
+ * Begin a span in the startup trace for handling the side effects of setting
+ * option "opt_idx".  Must be followed by trace_option_end().
+ */
+    static void
+trace_option_begin(int opt_idx)
+{
+    if (trace_fd != NULL)
+	trace_begin("option", (char_u *)options[opt_idx].fullname);
+}
+
+    static void
+trace_option_end(void)
+{
+    if (trace_fd != NULL)
+	trace_end();
+}
+#endif
+
 /*
  * Handle string options that need some action to perform when changed.
  * Returns NULL for success, or an error message for an error.
@@ -7576,6 +7647,10 @@ did_set_string_option(
 	    errmsg = e_invarg;
 	else
 	{
+	    /* Manual folding keeps the existing folds, compute the ones that
+	     * were postponed with the old method. */
+	    if (foldmethodIsManual(curwin))
+		foldLazyFinish(curwin, oldval);
 	    foldUpdateAll(curwin);
 	    if (foldmethodIsDiff(curwin))
 		newFoldLevel();
@@ -7825,6 +7900,10 @@ did_set_string_option(
     }
 #endif
 
+    /* 'runtimepath' and 'packpath' */
+    else if (varp == &p_rtp || varp == &p_pp)
+	clear_rtp_dirs();
+
     /* Options that are a list of flags. */
     else
     {
@@ -8438,6 +8517,9 @@ compile_cap_prog(synblock_T *synblock)
     regprog_T   *rp = synblock->b_cap_prog;
     char_u	*re;
 
+    /* Checking for a capital may give different results now. */
+    spell_cache_clear(synblock);
+
     if (*synblock->b_p_spc == NUL)
 	synblock->b_cap_prog = NULL;
     else
@@ -9620,6 +9702,23 @@ set_num_option(
 	errmsg = e_positive;
 	p_report = 1;
     }
+    if (p_umm < 0)
+    {
+	errmsg = e_positive;
+	p_umm = 0;
+    }
+    if (p_tca < 0)
+    {
+	errmsg = e_positive;
+	p_tca = 0;
+    }
+#if defined(FEAT_TERMINAL) && defined(FEAT_TIMERS)
+    if (p_twu < 0)
+    {
+	errmsg = e_positive;
+	p_twu = 0;
+    }
+#endif
     if ((p_sj < -100 || p_sj >= Rows) && full_screen)
     {
 	if (Rows != old_Rows)	/* Rows changed, just adjust p_sj */
@@ -10116,6 +10215,7 @@ set_option_value(
     int		opt_idx;
     char_u	*varp;
     long_u	flags;
+    char	*errmsg;
 
     opt_idx = findoption(name);
     if (opt_idx < 0)
@@ -10183,12 +10283,19 @@ set_option_value(
 
 		    }
 		}
+#ifdef STARTUPTIME
+		trace_option_begin(opt_idx);
+#endif
 		if (flags & P_NUM)
-		    return set_num_option(opt_idx, varp, number,
+		    errmsg = set_num_option(opt_idx, varp, number,
 							  NULL, 0, opt_flags);
 		else
-		    return set_bool_option(opt_idx, varp, (int)number,
+		    errmsg = set_bool_option(opt_idx, varp, (int)number,
 								   opt_flags);
+#ifdef STARTUPTIME
+		trace_option_end();
+#endif
+		return errmsg;
 	    }
 	}
     }
@@ -802,6 +802,7 @@ static char *(p_swb_values[]) = {"useopen", "usetab", "split", "newtab", "vsplit
 #define SWB_NEWTAB		0x008
 #define SWB_VSPLIT		0x010
 EXTERN int	p_tbs;		/* 'tagbsearch' */
+EXTERN long	p_tca;		/* 'tagcache' */
 EXTERN char_u	*p_tc;		/* 'tagcase' */
 EXTERN unsigned tc_flags;       /* flags from 'tagcase' */
 #ifdef IN_OPTION_C
@@ -812,6 +813,9 @@ static char *(p_tc_values[]) = {"followic", "ignore", "match", "followscs", "sma
 #define TC_MATCH		0x04
 #define TC_FOLLOWSCS		0x08
 #define TC_SMART		0x10
+#ifdef FEAT_TAG_BINS
+EXTERN int	p_tgi;		/* 'tagindex' */
+#endif
 EXTERN long	p_tl;		/* 'taglength' */
 EXTERN int	p_tr;		/* 'tagrelative' */
 EXTERN char_u	*p_tags;	/* 'tags' */
@@ -829,6 +833,9 @@ EXTERN int	p_tgc;		/* 'termguicolors' */
 #if defined(MSWIN) && defined(FEAT_TERMINAL)
 EXTERN char_u	*p_twt;		// 'termwintype'
 #endif
+#if defined(FEAT_TERMINAL) && defined(FEAT_TIMERS)
+EXTERN long	p_twu;		// 'termwinupdate'
+#endif
 EXTERN int	p_terse;	/* 'terse' */
 EXTERN int	p_ta;		/* 'textauto' */
 EXTERN int	p_to;		/* 'tildeop' */
@@ -889,6 +896,7 @@ static char *(p_ttym_values[]) = {"xterm", "xterm2", "dec", "netterm", "jsbterm"
 #endif
 EXTERN char_u	*p_udir;	/* 'undodir' */
 EXTERN long	p_ul;		/* 'undolevels' */
+EXTERN long	p_umm;		/* 'undomaxmem' */
 EXTERN long	p_ur;		/* 'undoreload' */
 EXTERN long	p_uc;		/* 'updatecount' */
 EXTERN long	p_ut;		/* 'updatetime' */
@@ -11,6 +11,7 @@ void do_shell(char_u *cmd, int flags);
 char_u *make_filter_cmd(char_u *cmd, char_u *itmp, char_u *otmp);
 void append_redir(char_u *buf, int buflen, char_u *opt, char_u *fname);
 int viminfo_error(char *errnum, char *message, char_u *line);
+void free_viminfo_marks_index(void);
 int read_viminfo(char_u *file, int flags);
 void write_viminfo(char_u *file, int forceit);
 int viminfo_readline(vir_T *virp);
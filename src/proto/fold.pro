@@ -26,6 +26,8 @@ void deleteFold(linenr_T start, linenr_T end, int recursive, int had_visual);
 void clearFolding(win_T *win);
 void foldUpdate(win_T *wp, linenr_T top, linenr_T bot);
 void foldUpdateAll(win_T *win);
+void foldLazyFinish(win_T *wp, char_u *fdm);
+long foldUpdateIdle(long next_due);
 int foldMoveTo(int updown, int dir, long count);
 void foldInitWin(win_T *new_win);
 int find_wl_entry(win_T *win, linenr_T lnum);
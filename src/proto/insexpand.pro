@@ -42,9 +42,12 @@ void ins_compl_addleader(int c);
 void ins_compl_addfrommatch(void);
 int ins_compl_prep(int c);
 int ins_compl_add_tv(typval_T *tv, int dir);
+void ins_compl_words_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, long xtra);
+void ins_compl_words_free(buf_T *buf);
 void ins_compl_delete(void);
 void ins_compl_insert(int in_compl_func);
 void ins_compl_check_keys(int frequency, int in_compl_func);
+void ins_compl_search_more(void);
 int ins_complete(int c, int enable_pum);
 void free_insexpand_stuff(void);
 /* vim: set ft=c : */
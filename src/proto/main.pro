@@ -10,6 +10,11 @@ void mainerr_arg_missing(char_u *str);
 void time_push(void *tv_rel, void *tv_start);
 void time_pop(void *tp);
 void time_msg(char *mesg, void *tv_start);
+void trace_open(char *fname);
+void trace_begin(char *cat, char_u *name);
+void trace_end(void);
+void trace_msg(char *mesg);
+void trace_close(void);
 void server_to_input_buf(char_u *str);
 char_u *eval_client_expr_to_string(char_u *expr);
 int sendToLocalVim(char_u *cmd, int asExpr, char_u **result);
@@ -11,6 +11,7 @@ int vim_regsub_multi(regmmatch_T *rmp, linenr_T lnum, char_u *source, char_u *de
 char_u *reg_submatch(int no);
 list_T *reg_submatch_list(int no);
 regprog_T *vim_regcomp(char_u *expr_arg, int re_flags);
+int vim_regcheck(char_u *expr, int re_flags);
 void vim_regfree(regprog_T *prog);
 int regprog_in_use(regprog_T *prog);
 int vim_regexec_prog(regprog_T **prog, int ignore_case, char_u *line, colnr_T col);
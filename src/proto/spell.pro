@@ -1,5 +1,9 @@
 /* spell.c */
 int spell_check(win_T *wp, char_u *ptr, hlf_T *attrp, int *capcol, int docount);
+int spell_check_cached(win_T *wp, linenr_T lnum, colnr_T col, char_u *ptr, hlf_T *attrp, int *capcol, int docount);
+void spell_cache_clear(synblock_T *block);
+void spell_cache_clear_buf(buf_T *buf);
+void spell_cache_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, long xtra);
 int spell_move_to(win_T *wp, int dir, int allwords, int curline, hlf_T *attrp);
 void spell_cat_line(char_u *buf, char_u *line, int maxlen);
 char_u *spell_enc(void);
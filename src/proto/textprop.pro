@@ -1,7 +1,11 @@
 /* textprop.c */
 void f_prop_add(typval_T *argvars, typval_T *rettv);
 void prop_add_common(linenr_T start_lnum, colnr_T start_col, dict_T *dict, buf_T *default_buf, typval_T *dict_arg);
+void f_prop_add_list(typval_T *argvars, typval_T *rettv);
 int get_text_props(buf_T *buf, linenr_T lnum, char_u **props, int will_change);
+void prop_index_add_line(buf_T *buf, linenr_T lnum, char_u *props, int count);
+void prop_index_adjust(buf_T *buf, linenr_T lnum, long added);
+void prop_index_clear(buf_T *buf);
 proptype_T *text_prop_type_by_id(buf_T *buf, int id);
 void f_prop_clear(typval_T *argvars, typval_T *rettv);
 void f_prop_list(typval_T *argvars, typval_T *rettv);
@@ -28,7 +28,6 @@ typedef struct qfline_S qfline_T;
 struct qfline_S
 {
     qfline_T	*qf_next;	// pointer to next error in the list
-    qfline_T	*qf_prev;	// pointer to previous error in the list
     linenr_T	qf_lnum;	// line number where the error occurred
     int		qf_fnum;	// file number for the line
     int		qf_col;		// column where the error occurred
@@ -41,6 +40,7 @@ struct qfline_S
     char_u	qf_type;	// type of the error (mostly 'E'); 1 for
 				// :helpgrep
     char_u	qf_valid;	// valid error message detected
+    char_u	qf_text_alloced; // qf_text was allocated, not in qf_blocks
 };
 
 /*
@@ -60,10 +60,28 @@ typedef enum
     QFLT_INTERNAL  // Internal - Temporary list used by getqflist()/getloclist()
 } qfltype_T;
 
+/*
+ * Entries and their text are allocated in blocks of memory, which are freed
+ * together with the list.  Avoids calling malloc() and free() for every entry
+ * and the overhead that comes with it.
+ */
+typedef struct qf_block_S qf_block_T;
+struct qf_block_S
+{
+    qf_block_T	*qb_next;	// next block in list
+    int		qb_used;	// nr of bytes already in use
+    int		qb_size;	// nr of bytes in qb_data[]
+    char_u	qb_data[1];	// data, actually longer
+};
+
+#define QF_BLOCK_SIZE 8000
+
 /*
  * Quickfix/Location list definition
  * Contains a list of entries (qfline_T). qf_start points to the first entry
  * and qf_last points to the last entry. qf_count contains the list size.
+ * qf_entries[n] points to entry n + 1, for quickly finding an entry by its
+ * number.
  *
  * Usually the list contains one or more entries. But an empty list can be
  * created using setqflist()/setloclist() with a title and/or user context
@@ -76,6 +94,9 @@ typedef struct qf_list_S
     qfline_T	*qf_start;	// pointer to the first error
     qfline_T	*qf_last;	// pointer to the last error
     qfline_T	*qf_ptr;	// pointer to the current error
+    qfline_T	**qf_entries;	// array of pointers to all entries
+    int		qf_entries_len;	// allocated size of qf_entries
+    qf_block_T	*qf_blocks;	// memory used for the entries
     int		qf_count;	// number of errors (0 means empty list)
     int		qf_index;	// current index in the error list
     int		qf_nonevalid;	// TRUE if not a single valid entry found
@@ -115,6 +136,8 @@ static qf_info_T ql_info;	// global quickfix list
 static int_u last_qf_id = 0;	// Last used quickfix list id
 
 #define FMT_PATTERNS 11		// maximum number of % recognized
+#define EFM_LEAD_MAX 16		// maximum length of literal text kept
+#define EFM_MUST_MAX 8		// maximum number of required characters
 
 /*
  * Structure used to hold the info of one part of 'errorformat'
@@ -142,6 +165,9 @@ struct efm_S
 				//   '-' do not include this line
 				//   '+' include whole line in message
     int		    conthere;	// %> used
+    char_u	    lead[EFM_LEAD_MAX]; // literal text a match starts with
+    int		    leadlen;	// number of bytes used in "lead"
+    char_u	    must[EFM_MUST_MAX + 1]; // characters a match contains
 };
 
 // List of location lists to be deleted.
@@ -397,16 +423,23 @@ efm_to_regpat(
     char_u	*efmp;
     int		round;
     int		idx = 0;
+    int		in_lead = TRUE;	// collecting "lead"
+    int		in_must = TRUE;	// collecting "must"
+    int		mustlen = 0;
+    int		added = 0;	// previous item added to "lead" and/or "must"
 
     // Build a regexp pattern for a 'errorformat' option part
     ptr = regpat;
     *ptr++ = '^';
     round = 0;
+    fmt_ptr->leadlen = 0;
+    fmt_ptr->must[0] = NUL;
     for (efmp = efm; efmp < efm + len; ++efmp)
     {
 	if (*efmp == '%')
 	{
 	    ++efmp;
+	    in_lead = FALSE;
 	    for (idx = 0; idx < FMT_PATTERNS; ++idx)
 		if (fmt_pat[idx].convchar == *efmp)
 		    break;
@@ -424,10 +457,28 @@ efm_to_regpat(
 		if (ptr == NULL)
 		    return FAIL;
 	    }
-	    else if (vim_strchr((char_u *)"%\\.^$~[", *efmp) != NULL)
-		*ptr++ = *efmp;		// regexp magic characters
-	    else if (*efmp == '#')
-		*ptr++ = '*';
+	    else if (vim_strchr((char_u *)"%\\.^$~[#", *efmp) != NULL)
+	    {
+		// Regexp items may make the previous character optional or
+		// change the meaning of what follows: stop collecting.
+		if (added & 1)
+		    --fmt_ptr->leadlen;
+		if (added & 2)
+		    fmt_ptr->must[--mustlen] = NUL;
+		in_must = FALSE;
+		if (*efmp == '\\' && efmp + 1 < efm + len && efmp[1] == '|')
+		{
+		    // "%\|": a line may match another branch, what was
+		    // collected so far is not required.
+		    fmt_ptr->leadlen = 0;
+		    mustlen = 0;
+		    fmt_ptr->must[0] = NUL;
+		}
+		if (*efmp == '#')
+		    *ptr++ = '*';
+		else
+		    *ptr++ = *efmp;	// regexp magic characters
+	    }
 	    else if (*efmp == '>')
 		fmt_ptr->conthere = TRUE;
 	    else if (efmp == efm + 1)		// analyse prefix
@@ -437,19 +488,59 @@ efm_to_regpat(
 		efmp = efm_analyze_prefix(efmp, fmt_ptr);
 		if (efmp == NULL)
 		    return FAIL;
+		in_lead = TRUE;
 	    }
 	    else
 	    {
 		semsg(_("E377: Invalid %%%c in format string"), *efmp);
 		return FAIL;
 	    }
+	    added = 0;
 	}
 	else			// copy normal character
 	{
+	    int	    magic = FALSE;
+
 	    if (*efmp == '\\' && efmp + 1 < efm + len)
+	    {
 		++efmp;
+		magic = vim_strchr((char_u *)".*^$~[\\", *efmp) != NULL;
+	    }
 	    else if (vim_strchr((char_u *)".*^$~[", *efmp) != NULL)
 		*ptr++ = '\\';	// escape regexp atoms
+
+	    if (magic)
+	    {
+		// A backslash makes a regexp item, same as with '%' above.
+		if (added & 1)
+		    --fmt_ptr->leadlen;
+		if (added & 2)
+		    fmt_ptr->must[--mustlen] = NUL;
+		in_lead = in_must = FALSE;
+		added = 0;
+	    }
+	    else if (*efmp != NUL)
+	    {
+		// Remember the ASCII text at the start and the punctuation
+		// characters that must appear, they are used to quickly
+		// reject lines in qf_parse_get_fields().
+		added = 0;
+		if (in_lead && *efmp < 0x80 && fmt_ptr->leadlen < EFM_LEAD_MAX)
+		{
+		    fmt_ptr->lead[fmt_ptr->leadlen++] = *efmp;
+		    added |= 1;
+		}
+		else
+		    in_lead = FALSE;
+		if (in_must && *efmp < 0x80 && ispunct(*efmp)
+			&& mustlen < EFM_MUST_MAX
+			&& vim_strchr(fmt_ptr->must, *efmp) == NULL)
+		{
+		    fmt_ptr->must[mustlen++] = *efmp;
+		    fmt_ptr->must[mustlen] = NUL;
+		    added |= 2;
+		}
+	    }
 	    if (*efmp)
 		*ptr++ = *efmp;
 	}
@@ -1214,6 +1305,7 @@ qf_parse_get_fields(
     regmatch_T	regmatch;
     int		status = QF_FAIL;
     int		r;
+    int		i;
 
     if (qf_multiscan &&
 		vim_strchr((char_u *)"OPQ", fmt_ptr->prefix) == NULL)
@@ -1231,6 +1323,16 @@ qf_parse_get_fields(
     fields->type = 0;
     *tail = NULL;
 
+    // Most lines don't match most formats: compare the literal text the
+    // format starts with before running the regexp.  A multi-byte character
+    // may fold to an ASCII one, let the regexp decide then.
+    for (i = 0; i < fmt_ptr->leadlen && linebuf[i] < 0x80; ++i)
+	if (TOLOWER_ASC(linebuf[i]) != TOLOWER_ASC(fmt_ptr->lead[i]))
+	    return QF_FAIL;
+    for (i = 0; fmt_ptr->must[i] != NUL; ++i)
+	if (vim_strchr(linebuf, fmt_ptr->must[i]) == NULL)
+	    return QF_FAIL;
+
     // Always ignore case when looking for a matching error.
     regmatch.rm_ic = TRUE;
     regmatch.regprog = fmt_ptr->prog;
@@ -1350,8 +1452,10 @@ qf_parse_multiline_pfx(
 		    == NULL)
 		return QF_FAIL;
 	    STRCPY(ptr, qfprev->qf_text);
-	    vim_free(qfprev->qf_text);
+	    if (qfprev->qf_text_alloced)
+		vim_free(qfprev->qf_text);
 	    qfprev->qf_text = ptr;
+	    qfprev->qf_text_alloced = TRUE;
 	    *(ptr += len) = '\n';
 	    STRCPY(++ptr, fields->errmsg);
 	}
@@ -2040,6 +2144,67 @@ check_quickfix_busy(void)
 }
 #endif
 
+/*
+ * Get "len" bytes of memory for an entry in list "qfl" or its text.
+ * When "align" is TRUE align the memory for a pointer.
+ * The memory is freed with qf_free_items().
+ * Returns NULL when out of memory.
+ */
+    static void *
+qf_getroom(qf_list_T *qfl, size_t len, int align)
+{
+    qf_block_T	*bl = qfl->qf_blocks;
+    qf_block_T	*nbl;
+    char_u	*p;
+    size_t	size;
+
+    if (align && bl != NULL)
+	bl->qb_used = (bl->qb_used + sizeof(char *) - 1)
+						      & ~(sizeof(char *) - 1);
+
+    if (bl == NULL || bl->qb_used + len > (size_t)bl->qb_size)
+    {
+	// Long text gets a block of its own, the current block can still be
+	// used for what follows.
+	size = len > QF_BLOCK_SIZE / 4 ? len : QF_BLOCK_SIZE;
+	nbl = alloc(sizeof(qf_block_T) + size);
+	if (nbl == NULL)
+	    return NULL;
+	nbl->qb_size = (int)size;
+	nbl->qb_used = (int)len;
+	if (bl != NULL && size == len)
+	{
+	    nbl->qb_next = bl->qb_next;
+	    bl->qb_next = nbl;
+	}
+	else
+	{
+	    nbl->qb_next = bl;
+	    qfl->qf_blocks = nbl;
+	}
+	return nbl->qb_data;
+    }
+
+    p = bl->qb_data + bl->qb_used;
+    bl->qb_used += (int)len;
+    return p;
+}
+
+/*
+ * Make a copy of string "s" in memory allocated with qf_getroom().
+ * Returns NULL when out of memory.
+ */
+    static char_u *
+qf_getroom_save(qf_list_T *qfl, char_u *s)
+{
+    char_u	*p;
+
+    p = qf_getroom(qfl, STRLEN(s) + 1, FALSE);
+    if (p != NULL)
+	STRCPY(p, s);
+    return p;
+}
+
 /*
  * Add an entry to the end of the list of errors.
  * Returns QF_OK or QF_FAIL.
@@ -2063,7 +2228,19 @@ qf_add_entry(
     qfline_T	*qfp;
     qfline_T	**lastp;	// pointer to qf_last or NULL
 
-    if ((qfp = ALLOC_ONE(qfline_T)) == NULL)
+    if (qfl->qf_count >= qfl->qf_entries_len)
+    {
+	int	    newlen = qfl->qf_entries_len == 0
+					     ? 64 : qfl->qf_entries_len * 2;
+	qfline_T    **entries;
+
+	entries = vim_realloc(qfl->qf_entries, newlen * sizeof(qfline_T *));
+	if (entries == NULL)
+	    return QF_FAIL;
+	qfl->qf_entries = entries;
+	qfl->qf_entries_len = newlen;
+    }
+    if ((qfp = qf_getroom(qfl, sizeof(qfline_T), TRUE)) == NULL)
 	return QF_FAIL;
     if (bufnum != 0)
     {
@@ -2076,31 +2253,20 @@ qf_add_entry(
     }
     else
 	qfp->qf_fnum = qf_get_fnum(qfl, dir, fname);
-    if ((qfp->qf_text = vim_strsave(mesg)) == NULL)
-    {
-	vim_free(qfp);
+    // The memory is freed with the list, not when failing here.
+    if ((qfp->qf_text = qf_getroom_save(qfl, mesg)) == NULL)
 	return QF_FAIL;
-    }
     qfp->qf_lnum = lnum;
     qfp->qf_col = col;
     qfp->qf_viscol = vis_col;
     if (pattern == NULL || *pattern == NUL)
 	qfp->qf_pattern = NULL;
-    else if ((qfp->qf_pattern = vim_strsave(pattern)) == NULL)
-    {
-	vim_free(qfp->qf_text);
-	vim_free(qfp);
+    else if ((qfp->qf_pattern = qf_getroom_save(qfl, pattern)) == NULL)
 	return QF_FAIL;
-    }
     if (module == NULL || *module == NUL)
 	qfp->qf_module = NULL;
-    else if ((qfp->qf_module = vim_strsave(module)) == NULL)
-    {
-	vim_free(qfp->qf_text);
-	vim_free(qfp->qf_pattern);
-	vim_free(qfp);
+    else if ((qfp->qf_module = qf_getroom_save(qfl, module)) == NULL)
 	return QF_FAIL;
-    }
     qfp->qf_nr = nr;
     if (type != 1 && !vim_isprintc(type)) // only printable chars allowed
 	type = 0;
@@ -2113,17 +2279,14 @@ qf_add_entry(
 	qfl->qf_start = qfp;
 	qfl->qf_ptr = qfp;
 	qfl->qf_index = 0;
-	qfp->qf_prev = NULL;
     }
     else
-    {
-	qfp->qf_prev = *lastp;
 	(*lastp)->qf_next = qfp;
-    }
     qfp->qf_next = NULL;
     qfp->qf_cleared = FALSE;
+    qfp->qf_text_alloced = FALSE;
     *lastp = qfp;
-    ++qfl->qf_count;
+    qfl->qf_entries[qfl->qf_count++] = qfp;
     if (qfl->qf_index == 0 && qfp->qf_valid)	// first valid entry
     {
 	qfl->qf_index = qfl->qf_count;
@@ -2274,6 +2437,9 @@ copy_loclist(qf_list_T *from_qfl, qf_list_T *to_qfl)
     to_qfl->qf_start = NULL;
     to_qfl->qf_last = NULL;
     to_qfl->qf_ptr = NULL;
+    to_qfl->qf_entries = NULL;
+    to_qfl->qf_entries_len = 0;
+    to_qfl->qf_blocks = NULL;
     if (from_qfl->qf_title != NULL)
 	to_qfl->qf_title = vim_strsave(from_qfl->qf_title);
     else
@@ -2683,10 +2849,10 @@ get_prev_valid_entry(
 
     do
     {
-	if (idx == 1 || qf_ptr->qf_prev == NULL)
+	if (idx <= 1)
 	    return NULL;
 	--idx;
-	qf_ptr = qf_ptr->qf_prev;
+	qf_ptr = qfl->qf_entries[idx - 1];
     } while ((!qfl->qf_nonevalid && !qf_ptr->qf_valid)
 	    || (dir == BACKWARD_FILE && qf_ptr->qf_fnum == old_qf_fnum));
 
@@ -2748,25 +2914,20 @@ get_nth_valid_entry(
     static qfline_T *
 get_nth_entry(qf_list_T *qfl, int errornr, int *new_qfidx)
 {
-    qfline_T	*qf_ptr = qfl->qf_ptr;
-    int		qf_idx = qfl->qf_index;
+    int		qf_idx = errornr;
 
-    // New error number is less than the current error number
-    while (errornr < qf_idx && qf_idx > 1 && qf_ptr->qf_prev != NULL)
-    {
-	--qf_idx;
-	qf_ptr = qf_ptr->qf_prev;
-    }
-    // New error number is greater than the current error number
-    while (errornr > qf_idx && qf_idx < qfl->qf_count &&
-						qf_ptr->qf_next != NULL)
+    if (qfl->qf_count == 0)
     {
-	++qf_idx;
-	qf_ptr = qf_ptr->qf_next;
+	*new_qfidx = qfl->qf_index;
+	return qfl->qf_ptr;
     }
+    if (qf_idx < 1)
+	qf_idx = 1;
+    else if (qf_idx > qfl->qf_count)
+	qf_idx = qfl->qf_count;
 
     *new_qfidx = qf_idx;
-    return qf_ptr;
+    return qfl->qf_entries[qf_idx - 1];
 }
 
 /*
@@ -3623,9 +3784,10 @@ qf_list(exarg_T *eap)
 
     if (qfl->qf_nonevalid)
 	all = TRUE;
-    FOR_ALL_QFL_ITEMS(qfl, qfp, i)
+    for (i = idx1 < 1 ? 1 : idx1; i <= idx2 && i <= qfl->qf_count; ++i)
     {
-	if ((qfp->qf_valid || all) && idx1 <= i && i <= idx2)
+	qfp = qfl->qf_entries[i - 1];
+	if (qfp->qf_valid || all)
 	    qf_list_entry(qfp, i, i == qfl->qf_index);
 
 	ui_breakcheck();
@@ -3777,31 +3939,24 @@ qf_history(exarg_T *eap)
     static void
 qf_free_items(qf_list_T *qfl)
 {
-    qfline_T	*qfp;
-    qfline_T	*qfpnext;
-    int		stop = FALSE;
+    qf_block_T	*bl;
+    int		i;
 
-    while (qfl->qf_count && qfl->qf_start != NULL)
+    // The entries and their text are in the blocks, except text that was
+    // extended by a continuation line.
+    for (i = 0; i < qfl->qf_count; ++i)
+	if (qfl->qf_entries[i]->qf_text_alloced)
+	    vim_free(qfl->qf_entries[i]->qf_text);
+    while (qfl->qf_blocks != NULL)
     {
-	qfp = qfl->qf_start;
-	qfpnext = qfp->qf_next;
-	if (!stop)
-	{
-	    vim_free(qfp->qf_module);
-	    vim_free(qfp->qf_text);
-	    vim_free(qfp->qf_pattern);
-	    stop = (qfp == qfpnext);
-	    vim_free(qfp);
-	    if (stop)
-		// Somehow qf_count may have an incorrect value, set it to 1
-		// to avoid crashing when it's wrong.
-		// TODO: Avoid qf_count being incorrect.
-		qfl->qf_count = 1;
-	}
-	qfl->qf_start = qfpnext;
-	--qfl->qf_count;
+	bl = qfl->qf_blocks;
+	qfl->qf_blocks = bl->qb_next;
+	vim_free(bl);
     }
+    VIM_CLEAR(qfl->qf_entries);
+    qfl->qf_entries_len = 0;
 
+    qfl->qf_count = 0;
     qfl->qf_index = 0;
     qfl->qf_start = NULL;
     qfl->qf_last = NULL;
@@ -5114,14 +5269,16 @@ qf_find_first_entry_in_buf(qf_list_T *qfl, int bnr, int *errornr)
  * the quickfix list by line number.
  */
     static qfline_T *
-qf_find_first_entry_on_line(qfline_T *entry, int *errornr)
+qf_find_first_entry_on_line(qf_list_T *qfl, qfline_T *entry, int *errornr)
 {
-    while (!got_int
-	    && entry->qf_prev != NULL
-	    && entry->qf_fnum == entry->qf_prev->qf_fnum
-	    && entry->qf_lnum == entry->qf_prev->qf_lnum)
+    qfline_T	*prev;
+
+    while (!got_int && *errornr > 1)
     {
-	entry = entry->qf_prev;
+	prev = qfl->qf_entries[*errornr - 2];
+	if (entry->qf_fnum != prev->qf_fnum || entry->qf_lnum != prev->qf_lnum)
+	    break;
+	entry = prev;
 	--*errornr;
     }
 
@@ -5260,6 +5417,7 @@ qf_find_entry_after_pos(
  */
     static qfline_T *
 qf_find_entry_before_pos(
+	qf_list_T	*qfl,
 	int		bnr,
 	pos_T		*pos,
 	int		linewise,
@@ -5280,7 +5438,7 @@ qf_find_entry_before_pos(
 
     if (linewise)
 	// If multiple entries are on the same line, then use the first entry
-	qfp = qf_find_first_entry_on_line(qfp, errornr);
+	qfp = qf_find_first_entry_on_line(qfl, qfp, errornr);
 
     return qfp;
 }
@@ -5310,7 +5468,7 @@ qf_find_closest_entry(
     if (dir == FORWARD)
 	qfp = qf_find_entry_after_pos(bnr, pos, linewise, qfp, errornr);
     else
-	qfp = qf_find_entry_before_pos(bnr, pos, linewise, qfp, errornr);
+	qfp = qf_find_entry_before_pos(qfl, bnr, pos, linewise, qfp, errornr);
 
     return qfp;
 }
@@ -5356,20 +5514,25 @@ qf_get_nth_below_entry(qfline_T *entry, int n, int linewise, int *errornr)
  * as one.
  */
     static void
-qf_get_nth_above_entry(qfline_T *entry, int n, int linewise, int *errornr)
+qf_get_nth_above_entry(
+	qf_list_T	*qfl,
+	qfline_T	*entry,
+	int		n,
+	int		linewise,
+	int		*errornr)
 {
     while (n-- > 0 && !got_int)
     {
-	if (entry->qf_prev == NULL
-		|| entry->qf_prev->qf_fnum != entry->qf_fnum)
+	if (*errornr <= 1
+		|| qfl->qf_entries[*errornr - 2]->qf_fnum != entry->qf_fnum)
 	    break;
 
-	entry = entry->qf_prev;
 	--*errornr;
+	entry = qfl->qf_entries[*errornr - 1];
 
 	// If multiple entries are on the same line, then use the first entry
 	if (linewise)
-	    entry = qf_find_first_entry_on_line(entry, errornr);
+	    entry = qf_find_first_entry_on_line(qfl, entry, errornr);
     }
 }
 
@@ -5401,7 +5564,7 @@ qf_find_nth_adj_entry(
 	if (dir == FORWARD)
 	    qf_get_nth_below_entry(adj_entry, n, linewise, &errornr);
 	else
-	    qf_get_nth_above_entry(adj_entry, n, linewise, &errornr);
+	    qf_get_nth_above_entry(qfl, adj_entry, n, linewise, &errornr);
     }
 
     return errornr;
@@ -8057,6 +8057,33 @@ vim_regcomp(char_u *expr_arg, int re_flags)
     return prog;
 }
 
+/*
+ * Check that "expr" is a valid pattern, giving an error message when it
+ * isn't.  This only does the first pass of the backtracking engine, which is
+ * much cheaper than vim_regcomp().  Used when compiling is postponed.
+ * Returns OK or FAIL.
+ */
+    int
+vim_regcheck(char_u *expr, int re_flags)
+{
+    int		flags;
+
+    if (expr == NULL)
+    {
+	emsg(_(e_null));
+	return FAIL;
+    }
+    if (STRNCMP(expr, "\\%#=", 4) == 0 && expr[4] != NUL)
+	expr += 5;
+    rex.reg_buf = curbuf;
+    init_class_tab();
+
+    regcomp_start(expr, re_flags);
+    regcode = JUST_CALC_SIZE;
+    regc(REGMAGIC);
+    return reg(REG_NOPAREN, &flags) == NULL ? FAIL : OK;
+}
+
 /*
  * Free a compiled regexp program, returned by vim_regcomp().
  */
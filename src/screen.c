@@ -4833,8 +4833,9 @@ win_line(
 			else
 			    p = prev_ptr;
 			cap_col -= (int)(prev_ptr - line);
-			len = spell_check(wp, p, &spell_hlf, &cap_col,
-								    nochange);
+			len = spell_check_cached(wp, lnum,
+				   (colnr_T)(prev_ptr - line), p, &spell_hlf,
+							   &cap_col, nochange);
 			word_end = v + len;
 
 			/* In Insert mode only highlight a word that
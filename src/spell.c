@@ -126,6 +126,11 @@ typedef struct suginfo_S
     char_u	su_sal_badword[MAXWLEN]; /* su_badword soundfolded */
     hashtab_T	su_banned;	    /* table with banned words */
     slang_T	*su_sallang;	    /* default language for sound folding */
+#ifdef FEAT_RELTIME
+    proftime_T	su_tm;		    /* time limit from 'spellsuggest' */
+    int		su_timeout;	    /* su_tm is set */
+#endif
+    int		su_timedout;	    /* time limit passed, stop searching */
 } suginfo_T;
 
 /* One word suggestion.  Used in "si_ga". */
@@ -243,6 +248,30 @@ typedef struct matchinf_S
     char_u	*mi_end2;		/* "mi_end" without following word */
 } matchinf_T;
 
+/*
+ * Cache for the results of spell_check() in a line, used by win_line() and
+ * spell_move_to() so that text that was checked before doesn't need to be
+ * checked again.  Kept in the synblock_T, sorted on line number, and updated
+ * by spell_cache_changed() when lines are changed.
+ */
+typedef struct
+{
+    colnr_T	scw_col;	/* column of the word */
+    char	scw_capzero;	/* "*capcol" was zero */
+    char	scw_attr;	/* resulting "*attrp", HLF_COUNT when OK */
+    int		scw_len;	/* returned length */
+    int		scw_capcol;	/* resulting "*capcol", MAXCOL if unchanged */
+} spellcacheword_T;
+
+typedef struct
+{
+    linenr_T	scl_lnum;	/* line number */
+    garray_T	scl_words;	/* spellcacheword_T items */
+} spellcacheline_T;
+
+/* When the cache has this many lines it is cleared. */
+#define SPELL_CACHE_MAXLINES 2000
+
 
 static int spell_iswordp(char_u *p, win_T *wp);
 static int spell_mb_isword_class(int cl, win_T *wp);
@@ -607,6 +636,186 @@ spell_check(
     return (int)(mi.mi_end - ptr);
 }
 
+/*
+ * Like spell_check(), but use the cached result for the word at column "col"
+ * in line "lnum" when there is one.  "*attrp" must be HLF_COUNT.
+ */
+    int
+spell_check_cached(
+    win_T	*wp,
+    linenr_T	lnum,
+    colnr_T	col,
+    char_u	*ptr,
+    hlf_T	*attrp,
+    int		*capcol,
+    int		docount)
+{
+    garray_T		*gap = &wp->w_s->b_spell_cache;
+    spellcacheline_T	*scl;
+    spellcacheword_T	*scw;
+    int			capzero = *capcol == 0;
+    int			cc;
+    int			len;
+    int			lo, hi, m;
+    int			i;
+
+    if (gap->ga_itemsize == 0)
+	ga_init2(gap, (int)sizeof(spellcacheline_T), 50);
+
+    /* Binary search for the line. */
+    lo = 0;
+    hi = gap->ga_len;
+    while (lo < hi)
+    {
+	m = (lo + hi) / 2;
+	if (((spellcacheline_T *)gap->ga_data)[m].scl_lnum < lnum)
+	    lo = m + 1;
+	else
+	    hi = m;
+    }
+    scl = (spellcacheline_T *)gap->ga_data + lo;
+    if (lo < gap->ga_len && scl->scl_lnum == lnum)
+    {
+	for (i = 0; i < scl->scl_words.ga_len; ++i)
+	{
+	    scw = (spellcacheword_T *)scl->scl_words.ga_data + i;
+	    if (scw->scw_col == col && scw->scw_capzero == capzero)
+	    {
+		*attrp = (hlf_T)scw->scw_attr;
+		if (scw->scw_capcol != MAXCOL)
+		    *capcol = scw->scw_capcol;
+		return scw->scw_len;
+	    }
+	}
+    }
+    else
+    {
+	/* Add an entry for the line. */
+	if (gap->ga_len >= SPELL_CACHE_MAXLINES)
+	{
+	    spell_cache_clear(wp->w_s);
+	    ga_init2(gap, (int)sizeof(spellcacheline_T), 50);
+	    lo = 0;
+	}
+	if (ga_grow(gap, 1) == FAIL)
+	    return spell_check(wp, ptr, attrp, capcol, docount);
+	scl = (spellcacheline_T *)gap->ga_data + lo;
+	mch_memmove(scl + 1, scl,
+			     (size_t)(gap->ga_len - lo) * sizeof(spellcacheline_T));
+	++gap->ga_len;
+	scl->scl_lnum = lnum;
+	ga_init2(&scl->scl_words, (int)sizeof(spellcacheword_T), 10);
+    }
+
+    /* spell_check() only looks at whether "*capcol" is zero.  When it isn't
+     * use MAXCOL to find out if spell_check() changed it. */
+    cc = capzero ? 0 : MAXCOL;
+    len = spell_check(wp, ptr, attrp, &cc, docount);
+    if (cc != MAXCOL)
+	*capcol = cc;
+
+    if (ga_grow(&scl->scl_words, 1) == OK)
+    {
+	scw = (spellcacheword_T *)scl->scl_words.ga_data
+						      + scl->scl_words.ga_len++;
+	scw->scw_col = col;
+	scw->scw_capzero = capzero;
+	scw->scw_attr = (char)*attrp;
+	scw->scw_len = len;
+	scw->scw_capcol = cc;
+    }
+    return len;
+}
+
+/*
+ * Clear the spell_check() cache of "block".
+ */
+    void
+spell_cache_clear(synblock_T *block)
+{
+    garray_T	*gap = &block->b_spell_cache;
+    int		i;
+
+    for (i = 0; i < gap->ga_len; ++i)
+	ga_clear(&((spellcacheline_T *)gap->ga_data)[i].scl_words);
+    ga_clear(gap);
+}
+
+/*
+ * Clear the spell_check() cache of "buf" and the windows that have their own
+ * synblock for it.  When "buf" is NULL do this for all buffers.
+ */
+    void
+spell_cache_clear_buf(buf_T *buf)
+{
+    buf_T	*bp;
+    win_T	*wp;
+    tabpage_T	*tp;
+
+    FOR_ALL_BUFFERS(bp)
+	if (buf == NULL || bp == buf)
+	    spell_cache_clear(&bp->b_s);
+    FOR_ALL_TAB_WINDOWS(tp, wp)
+	if ((buf == NULL || wp->w_buffer == buf)
+					 && wp->w_s != &wp->w_buffer->b_s)
+	    spell_cache_clear(wp->w_s);
+}
+
+/*
+ * Update the spell_check() cache of "block" for a change in lines "lnum" to
+ * "lnume" (exclusive), with "xtra" lines inserted (deleted if negative).
+ */
+    static void
+spell_cache_adjust(
+    synblock_T	*block,
+    linenr_T	lnum,
+    linenr_T	lnume,
+    long	xtra)
+{
+    garray_T		*gap = &block->b_spell_cache;
+    spellcacheline_T	*scl;
+    int			i;
+    int			n = 0;
+
+    for (i = 0; i < gap->ga_len; ++i)
+    {
+	scl = (spellcacheline_T *)gap->ga_data + i;
+
+	/* The line before the change may contain a word that continues in
+	 * the changed line. */
+	if (scl->scl_lnum >= lnum - 1 && scl->scl_lnum < lnume)
+	{
+	    ga_clear(&scl->scl_words);
+	    continue;
+	}
+	if (scl->scl_lnum >= lnume)
+	    scl->scl_lnum += xtra;
+	if (n != i)
+	    ((spellcacheline_T *)gap->ga_data)[n] = *scl;
+	++n;
+    }
+    gap->ga_len = n;
+}
+
+/*
+ * Called by changed_common() for a change in "buf".
+ */
+    void
+spell_cache_changed(
+    buf_T	*buf,
+    linenr_T	lnum,
+    linenr_T	lnume,
+    long	xtra)
+{
+    win_T	*wp;
+    tabpage_T	*tp;
+
+    spell_cache_adjust(&buf->b_s, lnum, lnume, xtra);
+    FOR_ALL_TAB_WINDOWS(tp, wp)
+	if (wp->w_buffer == buf && wp->w_s != &buf->b_s)
+	    spell_cache_adjust(wp->w_s, lnum, lnume, xtra);
+}
+
 /*
  * Check if the word at "mip->mi_word" is in the tree.
  * When "mode" is FIND_FOLDWORD check in fold-case word tree.
@@ -1615,7 +1824,8 @@ spell_move_to(
 
 	    /* start of word */
 	    attr = HLF_COUNT;
-	    len = spell_check(wp, p, &attr, &capcol, FALSE);
+	    len = spell_check_cached(wp, lnum, (colnr_T)(p - buf), p, &attr,
+							     &capcol, FALSE);
 
 	    if (attr != HLF_COUNT)
 	    {
@@ -1938,6 +2148,20 @@ slang_clear(slang_T *lp)
     int		i;
     int		round;
 
+#ifdef SPELL_MMAP
+    if (lp->sl_image != NULL)
+    {
+	/* The trees are in the mapped file, don't free them. */
+	munmap((void *)lp->sl_image, lp->sl_image_len);
+	lp->sl_image = NULL;
+	lp->sl_fbyts = NULL;
+	lp->sl_kbyts = NULL;
+	lp->sl_pbyts = NULL;
+	lp->sl_fidxs = NULL;
+	lp->sl_kidxs = NULL;
+	lp->sl_pidxs = NULL;
+    }
+#endif
     VIM_CLEAR(lp->sl_fbyts);
     VIM_CLEAR(lp->sl_kbyts);
     VIM_CLEAR(lp->sl_pbyts);
@@ -2296,6 +2520,7 @@ did_set_spelllang(win_T *wp)
 
     ga_init2(&ga, sizeof(langp_T), 2);
     clear_midword(wp);
+    spell_cache_clear(wp->w_s);
 
     /* Make a copy of 'spelllang', the SpellFileMissing autocommands may change
      * it under our fingers. */
@@ -2784,6 +3009,7 @@ spell_free_all(void)
     /* Go through all buffers and handle 'spelllang'. <VN> */
     FOR_ALL_BUFFERS(buf)
 	ga_clear(&buf->b_s.b_langp);
+    spell_cache_clear_buf(NULL);
 
     while (first_lang != NULL)
     {
@@ -3166,10 +3392,11 @@ spell_casefold(
 
 static int sps_flags = SPS_BEST;	/* flags from 'spellsuggest' */
 static int sps_limit = 9999;		/* max nr of suggestions given */
+static long sps_timeout = 0;		/* msec for searching, zero: no limit */
 
 /*
  * Check the 'spellsuggest' option.  Return FAIL if it's wrong.
- * Sets "sps_flags" and "sps_limit".
+ * Sets "sps_flags", "sps_limit" and "sps_timeout".
  */
     int
 spell_check_sps(void)
@@ -3181,6 +3408,7 @@ spell_check_sps(void)
 
     sps_flags = 0;
     sps_limit = 9999;
+    sps_timeout = 0;
 
     for (p = p_sps; *p != NUL; )
     {
@@ -3200,6 +3428,13 @@ spell_check_sps(void)
 	    f = SPS_FAST;
 	else if (STRCMP(buf, "double") == 0)
 	    f = SPS_DOUBLE;
+	else if (STRNCMP(buf, "timeout:", 8) == 0)
+	{
+	    s = buf + 8;
+	    sps_timeout = getdigits(&s);
+	    if (*s != NUL || !VIM_ISDIGIT(buf[8]))
+		f = -1;
+	}
 	else if (STRNCMP(buf, "expr:", 5) != 0
 		&& STRNCMP(buf, "file:", 5) != 0)
 	    f = -1;
@@ -3208,6 +3443,7 @@ spell_check_sps(void)
 	{
 	    sps_flags = SPS_BEST;
 	    sps_limit = 9999;
+	    sps_timeout = 0;
 	    return FAIL;
 	}
 	if (f != 0)
@@ -3664,6 +3900,7 @@ spell_find_suggest(
     char_u	buf[MAXPATHL];
     char_u	*p;
     int		do_combine = FALSE;
+    int		did_method = FALSE;
     char_u	*sps_copy;
 #ifdef FEAT_EVAL
     static int	expr_busy = FALSE;
@@ -3766,15 +4003,22 @@ spell_find_suggest(
 	else if (STRNCMP(buf, "file:", 5) == 0)
 	    /* Use list of suggestions in a file. */
 	    spell_suggest_file(su, buf + 5);
-	else
+	else if (STRNCMP(buf, "timeout:", 8) != 0)
 	{
 	    /* Use internal method. */
 	    spell_suggest_intern(su, interactive);
 	    if (sps_flags & SPS_DOUBLE)
 		do_combine = TRUE;
 	}
+	else
+	    continue;
+	did_method = TRUE;
     }
 
+    /* With only "timeout:" use the default method. */
+    if (!did_method && *sps_copy != NUL)
+	spell_suggest_intern(su, interactive);
+
     vim_free(sps_copy);
 
     if (do_combine)
@@ -3887,6 +4131,13 @@ spell_suggest_intern(suginfo_T *su, int interactive)
      */
     suggest_load_files();
 
+#ifdef FEAT_RELTIME
+    /* Start the time limit now, loading the .sug files doesn't count. */
+    su->su_timeout = sps_timeout > 0;
+    if (su->su_timeout)
+	profile_setlimit(sps_timeout, &su->su_tm);
+#endif
+
     /*
      * 1. Try special cases, such as repeating a word: "the the" -> "the".
      *
@@ -3908,7 +4159,7 @@ spell_suggest_intern(suginfo_T *su, int interactive)
     /*
      * 3. Try finding sound-a-like words.
      */
-    if ((sps_flags & SPS_FAST) == 0)
+    if ((sps_flags & SPS_FAST) == 0 && !su->su_timedout)
     {
 	if (sps_flags & SPS_BEST)
 	    /* Adjust the word score for the suggestions found so far for how
@@ -3929,13 +4180,13 @@ spell_suggest_intern(suginfo_T *su, int interactive)
 	su->su_maxscore = SCORE_SFMAX1;
 	su->su_sfmaxscore = SCORE_MAXINIT * 3;
 	suggest_try_soundalike(su);
-	if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su))
+	if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su) && !su->su_timedout)
 	{
 	    /* We didn't find enough matches, try again, allowing more
 	     * changes to the soundfold word. */
 	    su->su_maxscore = SCORE_SFMAX2;
 	    suggest_try_soundalike(su);
-	    if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su))
+	    if (su->su_ga.ga_len < SUG_CLEAN_COUNT(su) && !su->su_timedout)
 	    {
 		/* Still didn't find enough matches, try again, allowing even
 		 * more changes to the soundfold word. */
@@ -4180,6 +4431,8 @@ suggest_try_change(suginfo_T *su)
 	 * everything has been cleared. */
 	if (lp->lp_slang->sl_fbyts == NULL)
 	    continue;
+	if (su->su_timedout)
+	    break;
 
 	/* Try it for this language.  Will add possible suggestions. */
 #ifdef SUGGEST_PROFILE
@@ -4322,7 +4575,7 @@ suggest_trie_walk(
      * - When a state is done go to the next, set "ts_state".
      * - When all states are tried decrease "depth".
      */
-    while (depth >= 0 && !got_int)
+    while (depth >= 0 && !got_int && !su->su_timedout)
     {
 	sp = &stack[depth];
 	switch (sp->ts_state)
@@ -5659,6 +5912,10 @@ suggest_trie_walk(
 	    {
 		ui_breakcheck();
 		breakcheckcount = 1000;
+#ifdef FEAT_RELTIME
+		if (su->su_timeout && profile_passed_limit(&su->su_tm))
+		    su->su_timedout = TRUE;
+#endif
 	    }
 	}
     }
@@ -6128,6 +6385,8 @@ suggest_try_soundalike(suginfo_T *su)
     {
 	lp = LANGP_ENTRY(curwin->w_s->b_langp, lpi);
 	slang = lp->lp_slang;
+	if (su->su_timedout)
+	    break;
 	if (slang->sl_sal.ga_len > 0 && slang->sl_sbyts != NULL)
 	{
 	    /* soundfold the bad word */
@@ -36,6 +36,12 @@
 
 #define MAXREGIONS 8		/* Number of regions supported. */
 
+/* Use the word trees from the image in a .spl file in place, by mapping the
+ * file into memory. */
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+# define SPELL_MMAP
+#endif
+
 /* Type used for indexes in the word tree need to be at least 4 bytes.  If int
  * is 8 bytes we could use something smaller, but what? */
 typedef int idx_T;
@@ -71,6 +77,9 @@ struct slang_S
     idx_T	*sl_kidxs;	/* keep-case word indexes */
     char_u	*sl_pbyts;	/* prefix tree word bytes */
     idx_T	*sl_pidxs;	/* prefix tree word indexes */
+    char_u	*sl_image;	/* mapped .spl file the trees point into, or
+				   NULL when they were allocated */
+    size_t	sl_image_len;	/* size of "sl_image" */
 
     char_u	*sl_info;	/* infotext string or NULL */
 
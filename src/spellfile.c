@@ -19,6 +19,7 @@
  *			  <LWORDTREE>
  *			  <KWORDTREE>
  *			  <PREFIXTREE>
+ *			  [<IMAGE>]
  *
  * <HEADER>: <fileID> <versionnr>
  *
@@ -138,6 +139,10 @@
  * sectionID == SN_SYLLABLE: <syllable>
  * <syllable>    N bytes    String from SYLLABLE item.
  *
+ * sectionID == SN_IMAGE: <imageoffset>
+ * <imageoffset> 4 bytes    File offset of <IMAGE>, MSB first.  Zero when
+ *			    there is no image.
+ *
  * <LWORDTREE>: <wordtree>
  *
  * <KWORDTREE>: <wordtree>
@@ -209,6 +214,26 @@
  *			    from HEADER.
  *
  * All text characters are in 'encoding', but stored as single bytes.
+ *
+ *
+ * <IMAGE>: <imagemagic> <idxsize> <imagetree> <imagetree> <imagetree>
+ *
+ * The three word trees as they are stored in memory, so that the file can be
+ * mapped into memory and used without reading the trees.  Only used on a
+ * system with the same byte order and size of int as where it was written.
+ * Starts at a file offset that is a multiple of eight.  All numbers are in
+ * native byte order.
+ *
+ * <imagemagic>  4 bytes    SPELL_IMAGE_MAGIC
+ * <idxsize>     4 bytes    sizeof(idx_T)
+ *
+ * <imagetree>: <imagelen> <imageidxs> <imagebyts> <padding>
+ *
+ * <imagelen>	 4 bytes    Number of items in the arrays, zero for an empty
+ *			    tree.
+ * <imageidxs>	 N * <idxsize> bytes  The "idxs" array.
+ * <imagebyts>	 N bytes    The "byts" array.
+ * <padding>	 N bytes    Zero bytes up to a multiple of eight.
  */
 
 /*
@@ -269,6 +294,8 @@
 #define VIMSPELLMAGICL 8
 #define VIMSPELLVERSION 50
 
+#define SPELL_IMAGE_MAGIC 0x5370496d	/* <imagemagic> */
+
 /* Section IDs.  Only renumber them when VIMSPELLVERSION changes! */
 #define SN_REGION	0	/* <regionname> section */
 #define SN_CHARFLAGS	1	/* charflags section */
@@ -287,6 +314,7 @@
 #define SN_NOSPLITSUGS	14	/* don't split word for suggestions */
 #define SN_INFO		15	/* info section */
 #define SN_NOCOMPOUNDSUGS 16	/* don't compound for suggestions */
+#define SN_IMAGE	17	/* offset of the <IMAGE> */
 #define SN_END		255	/* end of sections */
 
 #define SNF_REQUIRED	1	/* <sectionflags>: required section */
@@ -309,6 +337,9 @@ static void set_sal_first(slang_T *lp);
 static int *mb_str2wide(char_u *s);
 static int spell_read_tree(FILE *fd, char_u **bytsp, idx_T **idxsp, int prefixtree, int prefixcnt);
 static idx_T read_tree_node(FILE *fd, char_u *byts, idx_T *idxs, int maxidx, idx_T startidx, int prefixtree, int maxprefcondnr);
+#ifdef SPELL_MMAP
+static int spell_map_image(FILE *fd, slang_T *lp, long imageoff);
+#endif
 static void set_spell_charflags(char_u *flags, int cnt, char_u *upp);
 static int set_spell_chartab(char_u *fol, char_u *low, char_u *upp);
 static void set_map_str(slang_T *lp, char_u *map);
@@ -352,6 +383,7 @@ spell_load_file(
     slang_T	*lp = NULL;
     int		c = 0;
     int		res;
+    long	imageoff = 0;
 
     fd = mch_fopen((char *)fname, "r");
     if (fd == NULL)
@@ -514,6 +546,12 @@ spell_load_file(
 		    goto endFAIL;
 		break;
 
+	    case SN_IMAGE:
+		imageoff = get4c(fd);			/* <imageoffset> */
+		if (imageoff < 0)
+		    goto truncerr;
+		break;
+
 	    default:
 		/* Unsupported section.  When it's required give an error
 		 * message.  When it's not required skip the contents. */
@@ -543,21 +581,28 @@ truncerr:
 	    goto endFAIL;
     }
 
-    /* <LWORDTREE> */
-    res = spell_read_tree(fd, &lp->sl_fbyts, &lp->sl_fidxs, FALSE, 0);
-    if (res != 0)
-	goto someerror;
-
-    /* <KWORDTREE> */
-    res = spell_read_tree(fd, &lp->sl_kbyts, &lp->sl_kidxs, FALSE, 0);
-    if (res != 0)
-	goto someerror;
-
-    /* <PREFIXTREE> */
-    res = spell_read_tree(fd, &lp->sl_pbyts, &lp->sl_pidxs, TRUE,
+#ifdef SPELL_MMAP
+    /* When the file has an <IMAGE> that can be used, the trees don't need
+     * to be read. */
+    if (imageoff == 0 || spell_map_image(fd, lp, imageoff) == FAIL)
+#endif
+    {
+	/* <LWORDTREE> */
+	res = spell_read_tree(fd, &lp->sl_fbyts, &lp->sl_fidxs, FALSE, 0);
+	if (res != 0)
+	    goto someerror;
+
+	/* <KWORDTREE> */
+	res = spell_read_tree(fd, &lp->sl_kbyts, &lp->sl_kidxs, FALSE, 0);
+	if (res != 0)
+	    goto someerror;
+
+	/* <PREFIXTREE> */
+	res = spell_read_tree(fd, &lp->sl_pbyts, &lp->sl_pidxs, TRUE,
 							    lp->sl_prefixcnt);
-    if (res != 0)
-	goto someerror;
+	if (res != 0)
+	    goto someerror;
+    }
 
     /* For a new file link it in the list of spell files. */
     if (old_lp == NULL && lang != NULL)
@@ -1598,6 +1643,167 @@ spell_read_tree(
     return 0;
 }
 
+#ifdef SPELL_MMAP
+/*
+ * Check the tree in "byts" and "idxs" of size "len" taken from a mapped
+ * <IMAGE>, it is used without copying.  Does the same checks as
+ * read_tree_node(): every node reachable from the root must fit in the
+ * arrays, child indexes must be below "len" and for a prefix tree the
+ * <prefcondnr> must be below "maxprefcondnr".
+ * Returns FAIL when the image is corrupt.
+ */
+    static int
+spell_check_image_tree(
+    char_u	*byts,
+    idx_T	*idxs,
+    int		len,
+    int		prefixtree,
+    int		maxprefcondnr)
+{
+    char_u	*done;
+    garray_T	todo;
+    idx_T	n;
+    idx_T	c;
+    int		count;
+    int		i;
+    int		retval = OK;
+
+    if (len == 0)
+	return OK;
+    done = alloc_clear((unsigned)(len / 8 + 1));
+    if (done == NULL)
+	return FAIL;
+    ga_init2(&todo, (int)sizeof(idx_T), 100);
+
+    n = 0;
+    for (;;)
+    {
+	count = byts[n];
+	if (count == 0 || n + count >= len)
+	{
+	    retval = FAIL;
+	    break;
+	}
+	for (i = 1; i <= count; ++i)
+	{
+	    c = idxs[n + i];
+	    if (byts[n + i] != 0)
+	    {
+		if (c < 0 || c >= len)
+		{
+		    retval = FAIL;
+		    break;
+		}
+		if ((done[c / 8] & (1 << (c % 8))) == 0)
+		{
+		    done[c / 8] |= 1 << (c % 8);
+		    if (ga_grow(&todo, 1) == FAIL)
+		    {
+			retval = FAIL;
+			break;
+		    }
+		    ((idx_T *)todo.ga_data)[todo.ga_len++] = c;
+		}
+	    }
+	    else if (prefixtree
+		     && (int)(((unsigned)c >> 8) & 0xffff) >= maxprefcondnr)
+	    {
+		retval = FAIL;
+		break;
+	    }
+	}
+	if (retval == FAIL || todo.ga_len == 0)
+	    break;
+	n = ((idx_T *)todo.ga_data)[--todo.ga_len];
+    }
+
+    ga_clear(&todo);
+    vim_free(done);
+    return retval;
+}
+
+/*
+ * Map the spell file "fd" into memory and make the word trees of "lp" point
+ * into the <IMAGE> at "imageoff".  The mapping is private, changes made to
+ * the trees (word counts for the .sug file) are not written back.
+ * The trees are checked like when reading them, a corrupt image is not used.
+ * Returns FAIL when the image can't be used, the trees must be read then.
+ */
+    static int
+spell_map_image(FILE *fd, slang_T *lp, long imageoff)
+{
+    stat_T	st;
+    char_u	*base;
+    char_u	*p;
+    char_u	*end;
+    int		round;
+    int		len;
+    char_u	*byts;
+    idx_T	*idxs;
+
+    if (fstat(fileno(fd), &st) < 0 || imageoff % 8 != 0
+					       || (off_T)imageoff >= st.st_size)
+	return FAIL;
+    base = (char_u *)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+					     MAP_PRIVATE, fileno(fd), (off_t)0);
+    if (base == (char_u *)MAP_FAILED)
+	return FAIL;
+
+    p = base + imageoff;
+    end = base + st.st_size;
+    if (end - p < 2 * (long)sizeof(int)
+	    || ((int *)p)[0] != SPELL_IMAGE_MAGIC		/* <imagemagic> */
+	    || ((int *)p)[1] != (int)sizeof(idx_T))		/* <idxsize> */
+	goto fail;
+    p += 2 * sizeof(int);
+
+    for (round = 1; round <= 3; ++round)
+    {
+	if (end - p < (long)sizeof(int))
+	    goto fail;
+	len = *(int *)p;					/* <imagelen> */
+	p += sizeof(int);
+	if (len < 0 || len > (end - p) / (long)(sizeof(idx_T) + 1))
+	    goto fail;
+	idxs = len == 0 ? NULL : (idx_T *)p;			/* <imageidxs> */
+	p += len * sizeof(idx_T);
+	byts = len == 0 ? NULL : p;				/* <imagebyts> */
+	p += len;
+	p += (8 - (p - base) % 8) % 8;				/* <padding> */
+
+	if (spell_check_image_tree(byts, idxs, len, round == 3,
+						  lp->sl_prefixcnt) == FAIL)
+	    goto fail;
+
+	if (round == 1)
+	{
+	    lp->sl_fbyts = byts;
+	    lp->sl_fidxs = idxs;
+	}
+	else if (round == 2)
+	{
+	    lp->sl_kbyts = byts;
+	    lp->sl_kidxs = idxs;
+	}
+	else
+	{
+	    lp->sl_pbyts = byts;
+	    lp->sl_pidxs = idxs;
+	}
+    }
+
+    lp->sl_image = base;
+    lp->sl_image_len = (size_t)st.st_size;
+    return OK;
+
+fail:
+    munmap((void *)base, (size_t)st.st_size);
+    lp->sl_fbyts = lp->sl_kbyts = lp->sl_pbyts = NULL;
+    lp->sl_fidxs = lp->sl_kidxs = lp->sl_pidxs = NULL;
+    return FAIL;
+}
+#endif
+
 /*
  * Read one row of siblings from the spell file and store it in the byte array
  * "byts" and index array "idxs".  Recursively read the children.
@@ -1740,6 +1946,7 @@ spell_reload_one(
 		/* reloading failed, clear the language */
 		slang_clear(slang);
 	    redraw_all_later(SOME_VALID);
+	    spell_cache_clear_buf(NULL);
 	    didit = TRUE;
 	}
     }
@@ -1987,6 +2194,7 @@ static int node_compress(spellinfo_T *spin, wordnode_T *node, hashtab_T *ht, int
 static int node_equal(wordnode_T *n1, wordnode_T *n2);
 static void clear_node(wordnode_T *node);
 static int put_node(FILE *fd, wordnode_T *node, int idx, int regionmask, int prefixtree);
+static int write_spell_image(char_u *fname, long offpos, int *nodecounts);
 static int sug_filltree(spellinfo_T *spin, slang_T *slang);
 static int sug_maketable(spellinfo_T *spin);
 static int sug_filltable(spellinfo_T *spin, wordnode_T *node, int startwordnr, garray_T *gap);
@@ -4826,6 +5034,7 @@ write_vim_spell(spellinfo_T *spin, char_u *fname)
     int		round;
     wordnode_T	*tree;
     int		nodecount;
+    int		nodecounts[3];
     int		i;
     int		l;
     garray_T	*gap;
@@ -4835,11 +5044,61 @@ write_vim_spell(spellinfo_T *spin, char_u *fname)
     int		retval = OK;
     size_t	fwv = 1;  /* collect return value of fwrite() to avoid
 			     warnings from picky compiler */
+    char_u	*tmpname = NULL;
+    long	imagepos = 0;
+    int		perm;
+    int		tmpfd = -1;
+#ifdef HAVE_READLINK
+    char_u	fname_buf[MAXPATHL];
+#endif
 
-    fd = mch_fopen((char *)fname, "w");
+    /* An .add.spl file is written often and small, it doesn't get an
+     * <IMAGE>.  Otherwise write to another file in the same directory and
+     * rename it when done, another Vim may have mapped the old file into
+     * memory. */
+    if (!spin->si_add)
+    {
+#ifdef HAVE_READLINK
+	/* Replace the file a symlink points to, not the symlink. */
+	if (resolve_symlink(fname, fname_buf) == OK)
+	    fname = fname_buf;
+#endif
+	tmpname = alloc((unsigned)STRLEN(fname) + 30);
+	if (tmpname == NULL)
+	    return FAIL;
+
+	/* Use a name that doesn't exist yet, never overwrite a file. */
+	for (i = 0; i < 100; ++i)
+	{
+	    sprintf((char *)tmpname, "%s.%ld.%d.tmp", fname,
+						    mch_get_pid(), i);
+	    tmpfd = mch_open((char *)tmpname,
+			 O_CREAT|O_EXTRA|O_WRONLY|O_EXCL|O_NOFOLLOW, 0666);
+	    if (tmpfd >= 0 || errno != EEXIST)
+		break;
+	}
+	if (tmpfd >= 0)
+	{
+	    /* Keep the permissions of the file that is replaced. */
+	    perm = mch_getperm(fname);
+	    if (perm >= 0)
+		(void)mch_setperm(tmpname, (long)perm);
+	    fd = fdopen(tmpfd, "w");
+	    if (fd == NULL)
+	    {
+		close(tmpfd);
+		mch_remove(tmpname);
+	    }
+	}
+	else
+	    fd = NULL;
+    }
+    else
+	fd = mch_fopen((char *)fname, "w");
     if (fd == NULL)
     {
-	semsg(_(e_notopen), fname);
+	semsg(_(e_notopen), tmpname == NULL ? fname : tmpname);
+	vim_free(tmpname);
 	return FAIL;
     }
 
@@ -5183,6 +5442,17 @@ write_vim_spell(spellinfo_T *spin, char_u *fname)
 							/* <syllable> */
     }
 
+    /* SN_IMAGE: <imageoffset>
+     * Filled in by write_spell_image() when the image was written. */
+    if (tmpname != NULL)
+    {
+	putc(SN_IMAGE, fd);				/* <sectionID> */
+	putc(0, fd);					/* <sectionflags> */
+	put_bytes(fd, (long_u)4, 4);			/* <sectionlen> */
+	imagepos = ftell(fd);
+	put_bytes(fd, (long_u)0, 4);			/* <imageoffset> */
+    }
+
     /* end of <SECTIONS> */
     putc(SN_END, fd);					/* <sectionend> */
 
@@ -5211,6 +5481,7 @@ write_vim_spell(spellinfo_T *spin, char_u *fname)
 	/* number of nodes in 4 bytes */
 	put_bytes(fd, (long_u)nodecount, 4);	/* <nodecount> */
 	spin->si_memtot += nodecount + nodecount * sizeof(int);
+	nodecounts[round - 1] = nodecount;
 
 	/* Write the nodes. */
 	(void)put_node(fd, tree, 0, regionmask, round == 3);
@@ -5228,6 +5499,97 @@ theend:
     if (retval == FAIL)
 	emsg(_(e_write));
 
+    if (tmpname != NULL)
+    {
+	/* Without the <IMAGE> the file is still valid, the trees are read
+	 * then. */
+	if (retval == OK && imagepos > 0)
+	    (void)write_spell_image(tmpname, imagepos, nodecounts);
+	if (retval == OK && vim_rename(tmpname, fname) != 0)
+	{
+	    semsg(_("E998: Can't rename spell file to %s"), fname);
+	    retval = FAIL;
+	}
+	if (retval == FAIL)
+	    mch_remove(tmpname);
+	vim_free(tmpname);
+    }
+
+    return retval;
+}
+
+/*
+ * Append the <IMAGE> to the .spl file "fname" and store its offset at
+ * "offpos".  The file is read back to get the trees as they are in memory.
+ * "nodecounts" has the <nodecount> of each tree.
+ * Return FAIL or OK.
+ */
+    static int
+write_spell_image(char_u *fname, long offpos, int *nodecounts)
+{
+    slang_T	*lp;
+    FILE	*fd;
+    long	off;
+    long	imageoff;
+    int		round;
+    int		len;
+    int		n;
+    char_u	*byts;
+    idx_T	*idxs;
+    int		retval = OK;
+    size_t	fwv = 1;
+
+    lp = spell_load_file(fname, NULL, NULL, FALSE);
+    if (lp == NULL)
+	return FAIL;
+    fd = mch_fopen((char *)fname, "r+");
+    if (fd == NULL)
+    {
+	slang_free(lp);
+	return FAIL;
+    }
+
+    fseek(fd, 0L, SEEK_END);
+    for (off = ftell(fd); off % 8 != 0; ++off)
+	putc(0, fd);
+    imageoff = off;
+
+    n = SPELL_IMAGE_MAGIC;
+    fwv &= fwrite(&n, sizeof(int), (size_t)1, fd);	/* <imagemagic> */
+    n = (int)sizeof(idx_T);
+    fwv &= fwrite(&n, sizeof(int), (size_t)1, fd);	/* <idxsize> */
+    off += 2 * sizeof(int);
+
+    for (round = 1; round <= 3; ++round)
+    {
+	byts = round == 1 ? lp->sl_fbyts
+			       : round == 2 ? lp->sl_kbyts : lp->sl_pbyts;
+	idxs = round == 1 ? lp->sl_fidxs
+			       : round == 2 ? lp->sl_kidxs : lp->sl_pidxs;
+	len = byts == NULL ? 0 : nodecounts[round - 1];
+
+	fwv &= fwrite(&len, sizeof(int), (size_t)1, fd);	/* <imagelen> */
+	if (len > 0)
+	{
+	    fwv &= fwrite(idxs, sizeof(idx_T) * len, (size_t)1, fd);
+							/* <imageidxs> */
+	    fwv &= fwrite(byts, (size_t)len, (size_t)1, fd);
+							/* <imagebyts> */
+	}
+	for (off += sizeof(int) + len * (sizeof(idx_T) + 1); off % 8 != 0;
+									 ++off)
+	    putc(0, fd);					/* <padding> */
+    }
+
+    /* Now that the image is complete, store its offset. */
+    if (fwv != (size_t)1 || fseek(fd, offpos, SEEK_SET) != 0)
+	retval = FAIL;
+    else
+	put_bytes(fd, (long_u)imageoff, 4);		/* <imageoffset> */
+
+    if (fclose(fd) == EOF)
+	retval = FAIL;
+    slang_free(lp);
     return retval;
 }
 
@@ -62,6 +62,7 @@ typedef struct frame_S		frame_T;
 typedef int			scid_T;		/* script ID */
 typedef struct file_buffer	buf_T;  /* forward declaration */
 typedef struct terminal_S	term_T;
+typedef struct compl_words_S	compl_words_T;
 
 #ifdef FEAT_MENU
 typedef struct VimMenu vimmenu_T;
@@ -362,6 +363,8 @@ struct u_entry
     linenr_T	ue_lcount;	/* linecount when u_save called */
     undoline_T	*ue_array;	/* array of lines in undo block */
     long	ue_size;	/* number of lines in ue_array */
+    off_T	ue_spill_off;	/* offset in the undo spill file, only valid
+				   when ue_array is NULL and ue_size > 0 */
 #ifdef U_DEBUG
     int		ue_magic;	/* magic number to check allocation */
 #endif
@@ -716,6 +719,32 @@ typedef struct textprop_S
 #define TP_FLAG_CONT_NEXT	1	// property continues in next line
 #define TP_FLAG_CONT_PREV	2	// property was continued from prev line
 
+/*
+ * Index of the lines that contain text properties of one type or with one ID.
+ * Used to avoid going over every line of the buffer to find a property.
+ * A line is added when a property is added to it, removed when it is found to
+ * no longer have the property.  Thus it may list too many lines, but never
+ * misses one.
+ */
+typedef struct propindex_S
+{
+    int		pi_type;	// property type ID, zero for an ID entry
+    int		pi_id;		// property ID when "pi_type" is zero
+    garray_T	pi_lines;	// sorted list of linenr_T
+    long	pi_shift;	// number of line shifts applied to "pi_lines"
+} propindex_T;
+
+/*
+ * Lines inserted or deleted in a buffer with a text property index.  The
+ * index entries apply them when they are used, thus inserting or deleting a
+ * line does not need to go over all entries.
+ */
+typedef struct propshift_S
+{
+    linenr_T	ps_lnum;	// lines inserted below or deleted from here
+    long	ps_added;	// number of lines inserted, negative if deleted
+} propshift_T;
+
 /*
  * Structure defining a property type.
  */
@@ -2067,6 +2096,7 @@ typedef struct {
 #ifdef FEAT_SPELL
     /* for spell checking */
     garray_T	b_langp;	/* list of pointers to slang_T, see spell.c */
+    garray_T	b_spell_cache;	/* cached spell_check() results per line */
     char_u	b_spell_ismw[256];/* flags: is midword char */
     char_u	*b_spell_ismw_mb; /* multi-byte midword chars */
     char_u	*b_p_spc;	/* 'spellcapcheck' */
@@ -2237,6 +2267,9 @@ struct file_buffer
     long	b_u_seq_cur;	/* hu_seq of header below which we are now */
     time_T	b_u_time_cur;	/* uh_time of header below which we are now */
     long	b_u_save_nr_cur; /* file write nr after which we are now */
+    long_u	b_u_memused;	/* bytes of undo text kept in memory */
+    FILE	*b_u_spill_fd;	/* undo text moved out for 'undomaxmem' */
+    char_u	*b_u_spill_fname; /* name of the file for b_u_spill_fd */
 
     /*
      * variables for "U" command in undo.c
@@ -2247,6 +2280,7 @@ struct file_buffer
 
 #ifdef FEAT_INS_EXPAND
     int		b_scanned;	/* ^N/^P have scanned this buffer */
+    compl_words_T *b_compl_words; /* index of words for ^N/^P, or NULL */
 #endif
 
     /* flags for use of ":lmap" and IM control */
@@ -2485,6 +2519,11 @@ struct file_buffer
 #ifdef FEAT_TEXT_PROP
     int		b_has_textprop;	// TRUE when text props were added
     hashtab_T	*b_proptypes;	// text property types local to buffer
+    garray_T	b_prop_index;	// list of propindex_T, sorted on type and ID
+    garray_T	b_prop_shifts;	// list of propshift_T not applied everywhere
+    long	b_prop_shift_first; // number of shifts before b_prop_shifts
+    int		b_prop_shift_used;  // last shift was applied to an entry
+    int		b_prop_index_stale; // b_prop_index must be built again
 #endif
 
 #if defined(FEAT_BEVAL) && defined(FEAT_EVAL)
@@ -2585,6 +2624,10 @@ struct file_buffer
 #endif
 #ifdef FEAT_DIFF
     int		b_diff_failed;	// internal diff failed for this buffer
+    unsigned long *b_diff_hash;	// xdiff hash of each line, zero when not
+				// computed yet; NULL when not used
+    linenr_T	b_diff_hash_len; // number of lines in b_diff_hash
+    int		b_diff_hash_flags; // 'diffopt' flags used for b_diff_hash
 #endif
 }; /* file_buffer */
 
@@ -2656,6 +2699,13 @@ struct tabpage_S
     buf_T	    *(tp_diffbuf[DB_COUNT]);
     int		    tp_diff_invalid;	// list of diffs is outdated
     int		    tp_diff_update;	// update diffs before redrawing
+    int		    tp_diff_incr;	// only lines in tp_diff_top and
+					// tp_diff_bot changed since the last
+					// update, the diffs can be updated
+					// for those lines only
+    linenr_T	    tp_diff_top[DB_COUNT]; // first changed line, zero when
+					   // the buffer did not change
+    linenr_T	    tp_diff_bot[DB_COUNT]; // last changed line
 #endif
     frame_T	    *(tp_snapshot[SNAP_COUNT]);  // window layout snapshots
 #ifdef FEAT_EVAL
@@ -2985,10 +3035,13 @@ struct window_S
 
 #ifdef FEAT_FOLDING
     garray_T	w_folds;	    /* array of nested folds */
+    garray_T	w_foldlvl;	    /* cached 'foldexpr' result per line */
     char	w_fold_manual;	    /* when TRUE: some folds are opened/closed
 				       manually */
     char	w_foldinvalid;	    /* when TRUE: folding needs to be
 				       recomputed */
+    linenr_T	w_foldlazy;	    /* when non-zero: folds from this line
+				       down have not been computed yet */
 #endif
 #ifdef FEAT_LINEBREAK
     int		w_nrwidth;	    /* width of 'number' and 'relativenumber'
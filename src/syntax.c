@@ -3627,6 +3627,9 @@ reset_synblock(win_T *wp)
     if (wp->w_s != &wp->w_buffer->b_s)
     {
 	syntax_clear(wp->w_s);
+#ifdef FEAT_SPELL
+	spell_cache_clear(wp->w_s);
+#endif
 	vim_free(wp->w_s);
 	wp->w_s = &wp->w_buffer->b_s;
     }
@@ -1284,6 +1284,671 @@ prepare_pats(pat_T *pats, int has_re)
 	pats->regmatch.regprog = NULL;
 }
 
+#ifdef FEAT_TAG_BINS
+/*
+ * Index of a tags file, used when 'tagindex' is set.  It holds the name of
+ * every tag in the file with the offset of its line, and the order of the
+ * names with case folded.  This finds the lines that may match a pattern
+ * without reading the whole file, also when ignoring case, when the file is
+ * not sorted or when the pattern is a regexp without a fixed start.
+ */
+typedef struct
+{
+    char_u	*ti_fname;	// name of the tags file
+    off_T	ti_size;	// size of the file when it was indexed
+    time_t	ti_mtime;	// modification time when it was indexed
+    int		ti_valid;	// FALSE when the file may have changed after
+				// indexing it
+    int		ti_count;	// number of tags, -1 when it can't be indexed
+    char_u	*ti_names;	// tag names, NUL terminated, in file order
+    long	ti_names_len;	// total length of ti_names[]
+    long	*ti_nameoff;	// offset in ti_names[] for each tag
+    off_T	*ti_lineoff;	// offset in the file for each tag line
+    int		*ti_sorted;	// tag numbers sorted on case-folded name
+} tagindex_T;
+
+static garray_T tag_indexes = {0, 0, sizeof(tagindex_T *), 4, NULL};
+
+static tagindex_T *tag_index_sorting;	// index used by tag_index_compare()
+
+    static void
+tag_index_free(tagindex_T *ti)
+{
+    vim_free(ti->ti_fname);
+    vim_free(ti->ti_names);
+    vim_free(ti->ti_nameoff);
+    vim_free(ti->ti_lineoff);
+    vim_free(ti->ti_sorted);
+    vim_free(ti);
+}
+
+/*
+ * Free all tags file indexes.
+ */
+    static void
+tag_index_clear(void)
+{
+    int		i;
+
+    for (i = 0; i < tag_indexes.ga_len; ++i)
+	tag_index_free(((tagindex_T **)tag_indexes.ga_data)[i]);
+    ga_clear(&tag_indexes);
+}
+
+/*
+ * Compare two tag names in "tag_index_sorting" with case folded, the way a
+ * case-fold sorted tags file is ordered.  Keep file order for equal names.
+ */
+    static int
+tag_index_compare(const void *s1, const void *s2)
+{
+    int		n1 = *(int *)s1;
+    int		n2 = *(int *)s2;
+    tagindex_T	*ti = tag_index_sorting;
+    int		res;
+
+    res = tag_strnicmp(ti->ti_names + ti->ti_nameoff[n1],
+			   ti->ti_names + ti->ti_nameoff[n2], (size_t)MAXCOL);
+    if (res == 0)
+	res = n1 == n2 ? 0 : n1 > n2 ? 1 : -1;
+    return res;
+}
+
+/*
+ * Read the tags file "fname" and fill "ti" with its index.
+ * Return FAIL when the file can't be indexed, e.g. for an Emacs style tags
+ * file or when interrupted.
+ */
+    static int
+tag_index_build(tagindex_T *ti, char_u *fname)
+{
+    FILE	*fp;
+    char_u	*lbuf;
+    char_u	*p;
+    off_T	offset;
+    garray_T	ga_names;
+    garray_T	ga_nameoff;
+    garray_T	ga_lineoff;
+    int		len;
+    int		i;
+    int		retval = FAIL;
+
+    if ((fp = mch_fopen((char *)fname, "r")) == NULL)
+	return FAIL;
+    lbuf = alloc(LSIZE);
+    ga_init2(&ga_names, 1, 10000);
+    ga_init2(&ga_nameoff, (int)sizeof(long), 1000);
+    ga_init2(&ga_lineoff, (int)sizeof(off_T), 1000);
+
+    if (lbuf != NULL)
+	for (;;)
+	{
+	    if ((ga_lineoff.ga_len & 0xfff) == 0)
+	    {
+		fast_breakcheck();
+		if (got_int)
+		    break;
+	    }
+	    offset = vim_ftell(fp);
+	    if (vim_fgets(lbuf, LSIZE, fp))
+	    {
+		retval = OK;	// reached the end of the file
+		break;
+	    }
+	    if (*lbuf == Ctrl_L)
+		break;		// Emacs tags are not indexed
+	    if (STRNCMP(lbuf, "!_TAG_", 6) == 0 || vim_isblankline(lbuf))
+		continue;
+	    p = vim_strchr(lbuf, TAB);
+	    if (p == NULL)
+	    {
+		// A long line is truncated and ignored when searching,
+		// anything else is an error that a linear search reports.
+		if (lbuf[LSIZE - 2] != NUL)
+		    continue;
+		break;
+	    }
+	    len = (int)(p - lbuf);
+	    if (ga_grow(&ga_names, len + 1) == FAIL
+		    || ga_grow(&ga_nameoff, 1) == FAIL
+		    || ga_grow(&ga_lineoff, 1) == FAIL)
+		break;
+	    ((long *)ga_nameoff.ga_data)[ga_nameoff.ga_len++] =
+							      ga_names.ga_len;
+	    ((off_T *)ga_lineoff.ga_data)[ga_lineoff.ga_len++] = offset;
+	    vim_strncpy((char_u *)ga_names.ga_data + ga_names.ga_len,
+								   lbuf, len);
+	    ga_names.ga_len += len + 1;
+	}
+    fclose(fp);
+    vim_free(lbuf);
+
+    if (retval == OK && ga_lineoff.ga_len > 0)
+    {
+	ti->ti_sorted = ALLOC_MULT(int, ga_lineoff.ga_len);
+	if (ti->ti_sorted == NULL)
+	    retval = FAIL;
+    }
+    if (retval == FAIL)
+    {
+	ga_clear(&ga_names);
+	ga_clear(&ga_nameoff);
+	ga_clear(&ga_lineoff);
+	return FAIL;
+    }
+
+    ti->ti_count = ga_lineoff.ga_len;
+    ti->ti_names = ga_names.ga_data;
+    ti->ti_names_len = ga_names.ga_len;
+    ti->ti_nameoff = ga_nameoff.ga_data;
+    ti->ti_lineoff = ga_lineoff.ga_data;
+    for (i = 0; i < ti->ti_count; ++i)
+	ti->ti_sorted[i] = i;
+    tag_index_sorting = ti;
+    qsort((void *)ti->ti_sorted, (size_t)ti->ti_count, sizeof(int),
+							   tag_index_compare);
+    return OK;
+}
+
+/*
+ * Return the position of tags file "fname" in tag_indexes, -1 if there is no
+ * index for it.
+ */
+    static int
+tag_index_find(char_u *fname)
+{
+    int		i;
+
+    for (i = 0; i < tag_indexes.ga_len; ++i)
+	if (fnamecmp(((tagindex_T **)tag_indexes.ga_data)[i]->ti_fname,
+								  fname) == 0)
+	    return i;
+    return -1;
+}
+
+# if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * Return the number of bytes used for the index of tags file "fname".
+ */
+    static long
+tag_index_memory(char_u *fname)
+{
+    int		i = tag_index_find(fname);
+    tagindex_T	*ti;
+
+    if (i < 0)
+	return 0L;
+    ti = ((tagindex_T **)tag_indexes.ga_data)[i];
+    if (ti->ti_count <= 0)
+	return 0L;
+    return ti->ti_names_len + (long)ti->ti_count
+		       * (long)(sizeof(long) + sizeof(off_T) + sizeof(int));
+}
+# endif
+
+/*
+ * Get the index for tags file "fname".  Uses the existing index if the file
+ * was not changed since it was made, otherwise (re)builds it.
+ * Returns NULL when there is no usable index.
+ */
+    static tagindex_T *
+tag_index_get(char_u *fname)
+{
+    stat_T	st;
+    tagindex_T	*ti;
+    int		i;
+
+    if (mch_stat((char *)fname, &st) < 0)
+	return NULL;
+
+    i = tag_index_find(fname);
+    if (i >= 0)
+    {
+	ti = ((tagindex_T **)tag_indexes.ga_data)[i];
+	if (ti->ti_valid && ti->ti_size == (off_T)st.st_size
+						 && ti->ti_mtime == st.st_mtime)
+	    return ti->ti_count < 0 ? NULL : ti;
+
+	// The file was changed, drop the old index.
+	tag_index_free(ti);
+	mch_memmove((tagindex_T **)tag_indexes.ga_data + i,
+		(tagindex_T **)tag_indexes.ga_data + i + 1,
+		(tag_indexes.ga_len - i - 1) * sizeof(tagindex_T *));
+	--tag_indexes.ga_len;
+    }
+
+    if (ga_grow(&tag_indexes, 1) == FAIL
+				 || (ti = ALLOC_CLEAR_ONE(tagindex_T)) == NULL)
+	return NULL;
+    ti->ti_fname = vim_strsave(fname);
+    if (ti->ti_fname == NULL)
+    {
+	vim_free(ti);
+	return NULL;
+    }
+    ti->ti_size = (off_T)st.st_size;
+    ti->ti_mtime = st.st_mtime;
+    // The time stamp has a resolution of a second, a change in the same
+    // second would go unnoticed.  Index the file again next time.
+    ti->ti_valid = st.st_mtime < vim_time();
+    if (tag_index_build(ti, fname) == FAIL)
+    {
+	if (got_int)
+	{
+	    // Interrupted: try again next time.
+	    tag_index_free(ti);
+	    return NULL;
+	}
+	// Remember that this file can't be indexed.
+	ti->ti_count = -1;
+    }
+    ((tagindex_T **)tag_indexes.ga_data)[tag_indexes.ga_len++] = ti;
+    return ti->ti_count < 0 ? NULL : ti;
+}
+
+    static int
+tag_index_offset_compare(const void *s1, const void *s2)
+{
+    off_T	o1 = *(off_T *)s1;
+    off_T	o2 = *(off_T *)s2;
+
+    return o1 == o2 ? 0 : o1 > o2 ? 1 : -1;
+}
+
+/*
+ * Find the lines in tags file index "ti" that may match "pats" and store
+ * their offsets in "gap", in file order.
+ * When the pattern has a fixed ASCII start a binary search on the case-folded
+ * names is used, otherwise all the names are matched with the pattern.
+ * Return FAIL when out of memory.
+ */
+    static int
+tag_index_lookup(tagindex_T *ti, pat_T *pats, garray_T *gap)
+{
+    char_u	*name;
+    int		plen;
+    int		lo, hi, mid;
+    int		n;
+    int		len;
+    int		match;
+
+    gap->ga_len = 0;
+
+    // Only ASCII is folded, like in a case-fold sorted tags file.
+    for (plen = 0; plen < pats->headlen && pats->head[plen] < 0x80; ++plen)
+	;
+
+    if (plen > 0)
+    {
+	// Find the first name starting with the head.
+	lo = 0;
+	hi = ti->ti_count;
+	while (lo < hi)
+	{
+	    mid = lo + (hi - lo) / 2;
+	    name = ti->ti_names + ti->ti_nameoff[ti->ti_sorted[mid]];
+	    if (tag_strnicmp(name, pats->head, (size_t)plen) < 0)
+		lo = mid + 1;
+	    else
+		hi = mid;
+	}
+	for ( ; lo < ti->ti_count; ++lo)
+	{
+	    n = ti->ti_sorted[lo];
+	    if (tag_strnicmp(ti->ti_names + ti->ti_nameoff[n], pats->head,
+							   (size_t)plen) != 0)
+		break;
+	    if (ga_grow(gap, 1) == FAIL)
+		return FAIL;
+	    ((off_T *)gap->ga_data)[gap->ga_len++] = ti->ti_lineoff[n];
+	}
+	qsort(gap->ga_data, (size_t)gap->ga_len, sizeof(off_T),
+						    tag_index_offset_compare);
+    }
+    else
+    {
+	for (n = 0; n < ti->ti_count; ++n)
+	{
+	    if ((n & 0xfff) == 0)
+	    {
+		fast_breakcheck();
+		if (got_int)
+		    break;
+	    }
+	    name = ti->ti_names + ti->ti_nameoff[n];
+	    len = (int)STRLEN(name);
+	    if (p_tl != 0 && len > p_tl)
+		len = p_tl;
+	    match = (len == pats->len
+			    && MB_STRNICMP(name, pats->pat, (size_t)len) == 0);
+	    if (!match && pats->regmatch.regprog != NULL)
+		match = vim_regexec(&pats->regmatch, name, (colnr_T)0);
+	    if (match)
+	    {
+		if (ga_grow(gap, 1) == FAIL)
+		    return FAIL;
+		((off_T *)gap->ga_data)[gap->ga_len++] = ti->ti_lineoff[n];
+	    }
+	}
+    }
+    return OK;
+}
+#endif
+
+/*
+ * A tags file being read by find_tags(): an open file or the contents of
+ * the file kept in the tags file cache.
+ */
+typedef struct
+{
+    FILE	*tr_fp;		// file to read from, NULL when using tr_data
+    char_u	*tr_data;	// cached contents of the file
+    off_T	tr_len;		// length of tr_data
+    off_T	tr_pos;		// offset of the next line in tr_data
+} tagreader_T;
+
+/*
+ * Contents of a tags file kept in memory when 'tagcache' is set, so that it
+ * does not need to be read again for every search.
+ */
+typedef struct
+{
+    char_u	*tc_fname;	// name of the tags file
+    off_T	tc_size;	// size of the file when it was read
+    time_t	tc_mtime;	// modification time when it was read
+    int		tc_valid;	// FALSE when the file may have changed after
+				// reading it
+    char_u	*tc_data;	// contents of the file
+    long_u	tc_used;	// value of tag_cache_tick when last used
+} tagcache_T;
+
+static garray_T tag_cache = {0, 0, sizeof(tagcache_T *), 4, NULL};
+static long_u	tag_cache_tick = 0;	// incremented for every use
+static long_u	tag_cache_size = 0;	// total size of cached contents
+
+/*
+ * Like vim_fgets() for a tags file reader.  For cached contents a CR before
+ * the NL is dropped where reading the file in text mode does that.
+ */
+    static int
+tag_fgets(char_u *buf, int size, tagreader_T *tr)
+{
+    char_u	*p;
+    char_u	*nl;
+    long	len;
+    long	n;
+
+    if (tr->tr_fp != NULL)
+	return vim_fgets(buf, size, tr->tr_fp);
+
+    if (tr->tr_pos >= tr->tr_len)
+    {
+	*buf = NUL;
+	return TRUE;
+    }
+    p = tr->tr_data + tr->tr_pos;
+    nl = memchr(p, '\n', (size_t)(tr->tr_len - tr->tr_pos));
+    if (nl == NULL)
+    {
+	len = (long)(tr->tr_len - tr->tr_pos);
+	tr->tr_pos = tr->tr_len;
+    }
+    else
+    {
+	len = (long)(nl - p);
+	tr->tr_pos += len + 1;
+#ifdef USE_CRNL
+	if (len > 0 && p[len - 1] == CAR)
+	    --len;
+#endif
+    }
+
+    // Like fgets(): at most "size - 1" bytes, including the NL.
+    buf[size - 2] = NUL;
+    n = len < size - 1 ? len : size - 1;
+    mch_memmove(buf, p, (size_t)n);
+    if (nl != NULL && n < size - 1)
+	buf[n++] = NL;
+    buf[n] = NUL;
+    return FALSE;
+}
+
+    static off_T
+tag_ftell(tagreader_T *tr)
+{
+    if (tr->tr_fp != NULL)
+	return vim_ftell(tr->tr_fp);
+    return tr->tr_pos;
+}
+
+    static void
+tag_fseek(tagreader_T *tr, off_T offset)
+{
+    if (tr->tr_fp != NULL)
+	vim_fseek(tr->tr_fp, offset, SEEK_SET);
+    else
+	tr->tr_pos = offset > tr->tr_len ? tr->tr_len : offset;
+}
+
+/*
+ * Return the size of the tags file, zero or negative when unknown.
+ */
+    static off_T
+tag_fsize(tagreader_T *tr)
+{
+    off_T	size;
+
+    if (tr->tr_fp == NULL)
+	return tr->tr_len;
+    // Don't use mch_fstat(), it's not portable.
+    size = vim_lseek(fileno(tr->tr_fp), (off_T)0L, SEEK_END);
+    vim_lseek(fileno(tr->tr_fp), (off_T)0L, SEEK_SET);
+    return size;
+}
+
+    static void
+tag_fclose(tagreader_T *tr)
+{
+    if (tr->tr_fp != NULL)
+	fclose(tr->tr_fp);
+    tr->tr_fp = NULL;
+    tr->tr_data = NULL;
+}
+
+/*
+ * Return the index of tags file "fname" in the tags file cache, -1 if it is
+ * not cached.
+ */
+    static int
+tag_cache_find(char_u *fname)
+{
+    int		i;
+
+    for (i = 0; i < tag_cache.ga_len; ++i)
+	if (fnamecmp(((tagcache_T **)tag_cache.ga_data)[i]->tc_fname,
+								  fname) == 0)
+	    return i;
+    return -1;
+}
+
+/*
+ * Remove entry "idx" from the tags file cache.
+ */
+    static void
+tag_cache_remove(int idx)
+{
+    tagcache_T	*tc = ((tagcache_T **)tag_cache.ga_data)[idx];
+
+    tag_cache_size -= (long_u)tc->tc_size;
+    vim_free(tc->tc_fname);
+    vim_free(tc->tc_data);
+    vim_free(tc);
+    mch_memmove((tagcache_T **)tag_cache.ga_data + idx,
+		(tagcache_T **)tag_cache.ga_data + idx + 1,
+		(tag_cache.ga_len - idx - 1) * sizeof(tagcache_T *));
+    if (--tag_cache.ga_len == 0)
+	ga_clear(&tag_cache);
+}
+
+/*
+ * Drop the least recently used files from the tags file cache until it fits
+ * in "maxsize" bytes.
+ */
+    static void
+tag_cache_trim(long_u maxsize)
+{
+    int		i;
+    int		lru;
+
+    while (tag_cache.ga_len > 0 && tag_cache_size > maxsize)
+    {
+	lru = 0;
+	for (i = 1; i < tag_cache.ga_len; ++i)
+	    if (((tagcache_T **)tag_cache.ga_data)[i]->tc_used
+			     < ((tagcache_T **)tag_cache.ga_data)[lru]->tc_used)
+		lru = i;
+	tag_cache_remove(lru);
+    }
+}
+
+/*
+ * Prepare "tr" for reading tags file "fname".  Uses the cached contents when
+ * the file did not change since it was read, reads the file into the cache
+ * when 'tagcache' is set and it fits, opens the file otherwise.
+ * Return FAIL when the file can't be read.
+ */
+    static int
+tag_fopen(tagreader_T *tr, char_u *fname)
+{
+    stat_T	st;
+    tagcache_T	*tc = NULL;
+    FILE	*fd;
+    int		i;
+
+    vim_memset(tr, 0, sizeof(tagreader_T));
+    if (p_tca > 0 && mch_stat((char *)fname, &st) >= 0)
+    {
+	i = tag_cache_find(fname);
+	if (i >= 0)
+	{
+	    tc = ((tagcache_T **)tag_cache.ga_data)[i];
+	    if (!tc->tc_valid || tc->tc_size != (off_T)st.st_size
+					       || tc->tc_mtime != st.st_mtime)
+	    {
+		// The file was changed, drop the old contents.
+		tag_cache_remove(i);
+		tc = NULL;
+	    }
+	}
+
+	if (tc == NULL && st.st_size > 0
+		&& (long_u)st.st_size <= (long_u)p_tca * 1024L)
+	{
+	    // Make room for the file, dropping the least recently used ones.
+	    tag_cache_trim((long_u)p_tca * 1024L - (long_u)st.st_size);
+	    if (ga_grow(&tag_cache, 1) == OK)
+		tc = ALLOC_CLEAR_ONE(tagcache_T);
+	}
+	if (tc != NULL && tc->tc_data == NULL)
+	{
+	    tc->tc_size = (off_T)st.st_size;
+	    tc->tc_mtime = st.st_mtime;
+	    // A change in the same second would go unnoticed, read the file
+	    // again next time.
+	    tc->tc_valid = st.st_mtime < vim_time();
+	    tc->tc_fname = vim_strsave(fname);
+	    tc->tc_data = lalloc((size_t)st.st_size, FALSE);
+	    fd = mch_fopen((char *)fname, READBIN);
+	    if (tc->tc_fname == NULL || tc->tc_data == NULL || fd == NULL
+		    || fread(tc->tc_data, 1, (size_t)st.st_size, fd)
+						       != (size_t)st.st_size)
+	    {
+		vim_free(tc->tc_fname);
+		vim_free(tc->tc_data);
+		VIM_CLEAR(tc);
+	    }
+	    else
+	    {
+		tag_cache_size += (long_u)tc->tc_size;
+		((tagcache_T **)tag_cache.ga_data)[tag_cache.ga_len++] = tc;
+	    }
+	    if (fd != NULL)
+		fclose(fd);
+	}
+
+	if (tc != NULL)
+	{
+	    tc->tc_used = ++tag_cache_tick;
+	    tr->tr_data = tc->tc_data;
+	    tr->tr_len = tc->tc_size;
+	    return OK;
+	}
+    }
+
+    if ((tr->tr_fp = mch_fopen((char *)fname, "r")) == NULL)
+	return FAIL;
+    return OK;
+}
+
+#if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * Add a dictionary to "list" with the memory used for tags file "fname":
+ * "cached" bytes for the contents and "index" bytes for the index.
+ */
+    static void
+add_tagcache_info(
+    list_T	*list,
+    char_u	*fname,
+    off_T	size,
+    long	cached,
+    long	index)
+{
+    dict_T	*dict = dict_alloc();
+
+    if (dict == NULL || list_append_dict(list, dict) == FAIL)
+	return;
+    dict_add_string(dict, "name", fname);
+    dict_add_number(dict, "size", (varnumber_T)size);
+    dict_add_number(dict, "cached", (varnumber_T)cached);
+    dict_add_number(dict, "index", (varnumber_T)index);
+}
+
+/*
+ * Add a dictionary to "list" for each tags file that is in the tags file
+ * cache or has an index, with the memory used for it.
+ */
+    void
+get_tagcache_info(list_T *list)
+{
+    int		i;
+    tagcache_T	*tc;
+# ifdef FEAT_TAG_BINS
+    tagindex_T	*ti;
+# endif
+
+    for (i = 0; i < tag_cache.ga_len; ++i)
+    {
+	tc = ((tagcache_T **)tag_cache.ga_data)[i];
+	add_tagcache_info(list, tc->tc_fname, tc->tc_size, (long)tc->tc_size,
+# ifdef FEAT_TAG_BINS
+		tag_index_memory(tc->tc_fname)
+# else
+		0L
+# endif
+		);
+    }
+# ifdef FEAT_TAG_BINS
+    for (i = 0; i < tag_indexes.ga_len; ++i)
+    {
+	ti = ((tagindex_T **)tag_indexes.ga_data)[i];
+	if (ti->ti_count >= 0 && tag_cache_find(ti->ti_fname) < 0)
+	    add_tagcache_info(list, ti->ti_fname, ti->ti_size, 0L,
+					      tag_index_memory(ti->ti_fname));
+    }
+# endif
+}
+#endif
+
 #ifdef FEAT_EVAL
 /*
  * Call the user-defined function to generate a list of tags used by
@@ -1552,7 +2217,7 @@ find_tags(
 					     other: minimal number of matches */
     char_u	*buf_ffname)		/* name of buffer for priority */
 {
-    FILE       *fp;
+    tagreader_T	tr;			/* tags file being read */
     char_u     *lbuf;			/* line buffer */
     int		lbuf_size = LSIZE;	/* length of lbuf */
     char_u     *tag_fname;		/* name of tag file */
@@ -1594,7 +2259,8 @@ find_tags(
 #ifdef FEAT_TAG_BINS
 	, TS_BINARY,		/* binary searching */
 	TS_SKIP_BACK,		/* skipping backwards */
-	TS_STEP_FORWARD		/* stepping forwards */
+	TS_STEP_FORWARD,	/* stepping forwards */
+	TS_INDEX		/* reading lines found with the index */
 #endif
     }	state;			/* Current search state */
 
@@ -1613,8 +2279,8 @@ find_tags(
 # define INCSTACK_SIZE 42
     struct
     {
-	FILE	*fp;
-	char_u	*etag_fname;
+	tagreader_T	tr;
+	char_u		*etag_fname;
     } incstack[INCSTACK_SIZE];
 
     int		incstack_idx = 0;	/* index in incstack */
@@ -1647,6 +2313,8 @@ find_tags(
     int		sort_error = FALSE;		/* tags file not sorted */
     int		linear;				/* do a linear search */
     int		sortic = FALSE;			/* tag file sorted in nocase */
+    garray_T	ga_index;			/* line offsets from index */
+    int		index_next = 0;			/* next item in ga_index */
 #endif
     int		line_error = FALSE;		/* syntax error */
     int		has_re = (flags & TAG_REGEXP);	/* regexp used */
@@ -1693,6 +2361,13 @@ find_tags(
 	ga_init2(&ga_match[mtt], (int)sizeof(char_u *), 100);
 	hash_init(&ht_match[mtt]);
     }
+#ifdef FEAT_TAG_BINS
+    ga_init2(&ga_index, (int)sizeof(off_T), 100);
+    if (!p_tgi && tag_indexes.ga_len > 0)
+	tag_index_clear();
+#endif
+    if (tag_cache_size > (long_u)p_tca * 1024L)
+	tag_cache_trim((long_u)p_tca * 1024L);
 
     /* check for out of memory situation */
     if (lbuf == NULL || tag_fname == NULL
@@ -1813,7 +2488,7 @@ find_tags(
 	 */
 #ifdef FEAT_CSCOPE
 	if (use_cscope)
-	    fp = NULL;	    /* avoid GCC warning */
+	    tr.tr_fp = NULL;	/* avoid GCC warning */
 	else
 #endif
 	{
@@ -1872,7 +2547,7 @@ find_tags(
 	    }
 #endif
 
-	    if ((fp = mch_fopen((char *)tag_fname, "r")) == NULL)
+	    if (tag_fopen(&tr, tag_fname) == FAIL)
 		continue;
 
 	    if (p_verbose >= 5)
@@ -1945,7 +2620,7 @@ find_tags(
 		if (search_info.curr_offset < 0)
 		{
 		    search_info.curr_offset = 0;
-		    rewind(fp);
+		    tag_fseek(&tr, (off_T)0);
 		    state = TS_STEP_FORWARD;
 		}
 	    }
@@ -1958,37 +2633,49 @@ find_tags(
 	    {
 		/* Adjust the search file offset to the correct position */
 		search_info.curr_offset_used = search_info.curr_offset;
-		vim_fseek(fp, search_info.curr_offset, SEEK_SET);
-		eof = vim_fgets(lbuf, LSIZE, fp);
+		tag_fseek(&tr, search_info.curr_offset);
+		eof = tag_fgets(lbuf, LSIZE, &tr);
 		if (!eof && search_info.curr_offset != 0)
 		{
 		    /* The explicit cast is to work around a bug in gcc 3.4.2
 		     * (repeated below). */
-		    search_info.curr_offset = vim_ftell(fp);
+		    search_info.curr_offset = tag_ftell(&tr);
 		    if (search_info.curr_offset == search_info.high_offset)
 		    {
 			/* oops, gone a bit too far; try from low offset */
-			vim_fseek(fp, search_info.low_offset, SEEK_SET);
+			tag_fseek(&tr, search_info.low_offset);
 			search_info.curr_offset = search_info.low_offset;
 		    }
-		    eof = vim_fgets(lbuf, LSIZE, fp);
+		    eof = tag_fgets(lbuf, LSIZE, &tr);
 		}
 		/* skip empty and blank lines */
 		while (!eof && vim_isblankline(lbuf))
 		{
-		    search_info.curr_offset = vim_ftell(fp);
-		    eof = vim_fgets(lbuf, LSIZE, fp);
+		    search_info.curr_offset = tag_ftell(&tr);
+		    eof = tag_fgets(lbuf, LSIZE, &tr);
 		}
 		if (eof)
 		{
 		    /* Hit end of file.  Skip backwards. */
 		    state = TS_SKIP_BACK;
-		    search_info.match_offset = vim_ftell(fp);
+		    search_info.match_offset = tag_ftell(&tr);
 		    search_info.curr_offset = search_info.curr_offset_used;
 		    continue;
 		}
 	    }
 
+	    /*
+	     * Using the index: read the next line that may match.
+	     */
+	    else if (state == TS_INDEX)
+	    {
+		if (index_next >= ga_index.ga_len)
+		    break;
+		tag_fseek(&tr, ((off_T *)ga_index.ga_data)[index_next++]);
+		if (tag_fgets(lbuf, LSIZE, &tr))
+		    break;
+	    }
+
 	    /*
 	     * Not jumping around in the file: Read the next line.
 	     */
@@ -2003,7 +2690,7 @@ find_tags(
 			eof = cs_fgets(lbuf, LSIZE);
 		    else
 #endif
-			eof = vim_fgets(lbuf, LSIZE, fp);
+			eof = tag_fgets(lbuf, LSIZE, &tr);
 		} while (!eof && vim_isblankline(lbuf));
 
 		if (eof)
@@ -2012,8 +2699,8 @@ find_tags(
 		    if (incstack_idx)	/* this was an included file */
 		    {
 			--incstack_idx;
-			fclose(fp);	/* end of this file ... */
-			fp = incstack[incstack_idx].fp;
+			tag_fclose(&tr);	/* end of this file ... */
+			tr = incstack[incstack_idx].tr;
 			STRCPY(tag_fname, incstack[incstack_idx].etag_fname);
 			vim_free(incstack[incstack_idx].etag_fname);
 			is_etag = 1;	/* (only etags can include) */
@@ -2068,7 +2755,7 @@ line_read_in:
 	    {
 		is_etag = 1;		/* in case at the start */
 		state = TS_LINEAR;
-		if (!vim_fgets(ebuf, LSIZE, fp))
+		if (!tag_fgets(ebuf, LSIZE, &tr))
 		{
 		    for (p = ebuf; *p && *p != ','; p++)
 			;
@@ -2081,23 +2768,24 @@ line_read_in:
 		    if (STRNCMP(p + 1, "include", 7) == 0
 					      && incstack_idx < INCSTACK_SIZE)
 		    {
-			/* Save current "fp" and "tag_fname" in the stack. */
+			/* Save current "tr" and "tag_fname" in the stack. */
 			if ((incstack[incstack_idx].etag_fname =
 					      vim_strsave(tag_fname)) != NULL)
 			{
 			    char_u *fullpath_ebuf;
 
-			    incstack[incstack_idx].fp = fp;
-			    fp = NULL;
+			    incstack[incstack_idx].tr = tr;
+			    vim_memset(&tr, 0, sizeof(tagreader_T));
 
-			    /* Figure out "tag_fname" and "fp" to use for
+			    /* Figure out "tag_fname" and "tr" to use for
 			     * included file. */
 			    fullpath_ebuf = expand_tag_fname(ebuf,
 							    tag_fname, FALSE);
 			    if (fullpath_ebuf != NULL)
 			    {
-				fp = mch_fopen((char *)fullpath_ebuf, "r");
-				if (fp != NULL)
+				tr.tr_fp = mch_fopen((char *)fullpath_ebuf,
+									 "r");
+				if (tr.tr_fp != NULL)
 				{
 				    if (STRLEN(fullpath_ebuf) > LSIZE)
 					  semsg(_("E430: Tag file path truncated for %s\n"), ebuf);
@@ -2108,11 +2796,11 @@ line_read_in:
 				}
 				vim_free(fullpath_ebuf);
 			    }
-			    if (fp == NULL)
+			    if (tr.tr_fp == NULL)
 			    {
 				/* Can't open the included file, skip it and
-				 * restore old value of "fp". */
-				fp = incstack[incstack_idx].fp;
+				 * restore old value of "tr". */
+				tr = incstack[incstack_idx].tr;
 				vim_free(incstack[incstack_idx].etag_fname);
 			    }
 			}
@@ -2197,6 +2885,29 @@ line_read_in:
 		    linear = TRUE;
 		    state = TS_LINEAR;
 		}
+
+		/*
+		 * Instead of a linear search use the index of the tags file
+		 * when 'tagindex' is set, to only read lines that may match.
+		 */
+		if (state == TS_LINEAR && p_tgi
+# ifdef FEAT_CSCOPE
+			&& !use_cscope
+# endif
+			&& vimconv.vc_type == CONV_NONE
+			&& (orgpat.headlen > 0
+					   || orgpat.regmatch.regprog != NULL))
+		{
+		    tagindex_T	*ti = tag_index_get(tag_fname);
+
+		    if (ti != NULL
+			      && tag_index_lookup(ti, &orgpat, &ga_index) == OK)
+		    {
+			state = TS_INDEX;
+			index_next = 0;
+			continue;
+		    }
+		}
 #else
 		state = TS_LINEAR;
 #endif
@@ -2208,15 +2919,11 @@ line_read_in:
 		 */
 		if (state == TS_BINARY)
 		{
-		    /* Get the tag file size (don't use mch_fstat(), it's not
-		     * portable). */
-		    if ((filesize = vim_lseek(fileno(fp),
-						   (off_T)0L, SEEK_END)) <= 0)
+		    /* Get the tag file size. */
+		    if ((filesize = tag_fsize(&tr)) <= 0)
 			state = TS_LINEAR;
 		    else
 		    {
-			vim_lseek(fileno(fp), (off_T)0L, SEEK_SET);
-
 			/* Calculate the first read offset in the file.  Start
 			 * the search in the middle of the file. */
 			search_info.low_offset = 0;
@@ -2248,12 +2955,12 @@ parse_line:
 		    verbose_leave();
 		}
 #ifdef FEAT_TAG_BINS
-		if (state != TS_LINEAR)
+		if (state != TS_LINEAR && state != TS_INDEX)
 		{
 		    // Avoid getting stuck.
 		    linear = TRUE;
 		    state = TS_LINEAR;
-		    vim_fseek(fp, search_info.low_offset, SEEK_SET);
+		    tag_fseek(&tr, search_info.low_offset);
 		}
 #endif
 		continue;
@@ -2289,7 +2996,11 @@ parse_line:
 		    cmplen = p_tl;
 		if (has_re && orgpat.headlen < cmplen)
 		    cmplen = orgpat.headlen;
-		else if (state == TS_LINEAR && orgpat.headlen != cmplen)
+		else if ((state == TS_LINEAR
+#ifdef FEAT_TAG_BINS
+			    || state == TS_INDEX
+#endif
+			    ) && orgpat.headlen != cmplen)
 		    continue;
 
 #ifdef FEAT_TAG_BINS
@@ -2336,7 +3047,7 @@ parse_line:
 		    }
 		    if (tagcmp < 0)
 		    {
-			search_info.curr_offset = vim_ftell(fp);
+			search_info.curr_offset = tag_ftell(&tr);
 			if (search_info.curr_offset < search_info.high_offset)
 			{
 			    search_info.low_offset = search_info.curr_offset;
@@ -2377,7 +3088,7 @@ parse_line:
 		{
 		    if (MB_STRNICMP(tagp.tagname, orgpat.head, cmplen) != 0)
 		    {
-			if ((off_T)vim_ftell(fp) > search_info.match_offset)
+			if ((off_T)tag_ftell(&tr) > search_info.match_offset)
 			    break;	/* past last match */
 			else
 			    continue;	/* before first match */
@@ -2700,7 +3411,7 @@ parse_line:
 #ifdef FEAT_CSCOPE
 	    if (!use_cscope)
 #endif
-		semsg(_("Before byte %ld"), (long)vim_ftell(fp));
+		semsg(_("Before byte %ld"), (long)tag_ftell(&tr));
 	    stop_searching = TRUE;
 	    line_error = FALSE;
 	}
@@ -2708,12 +3419,12 @@ parse_line:
 #ifdef FEAT_CSCOPE
 	if (!use_cscope)
 #endif
-	    fclose(fp);
+	    tag_fclose(&tr);
 #ifdef FEAT_EMACS_TAGS
 	while (incstack_idx)
 	{
 	    --incstack_idx;
-	    fclose(incstack[incstack_idx].fp);
+	    tag_fclose(&incstack[incstack_idx].tr);
 	    vim_free(incstack[incstack_idx].etag_fname);
 	}
 #endif
@@ -2721,6 +3432,7 @@ parse_line:
 	    convert_setup(&vimconv, NULL, NULL);
 
 #ifdef FEAT_TAG_BINS
+	ga_clear(&ga_index);
 	tag_file_sorted = NUL;
 	if (sort_error)
 	{
@@ -2858,6 +3570,10 @@ found_tagfile_cb(char_u *fname, void *cookie UNUSED)
 free_tag_stuff(void)
 {
     ga_clear_strings(&tag_fnames);
+# ifdef FEAT_TAG_BINS
+    tag_index_clear();
+# endif
+    tag_cache_trim(0L);
     if (curwin != NULL)
 	do_tag(NULL, DT_FREE, 0, 0, 0);
     tag_freematch();
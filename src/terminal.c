@@ -31,6 +31,9 @@
  * terminal emulator invokes callbacks when its screen content changes.  The
  * line range is stored in tl_dirty_row_start and tl_dirty_row_end.  Once in a
  * while, if the terminal window is visible, the screen contents is drawn.
+ * Output arriving within 'termwinupdate' msec of the last redraw is not drawn
+ * right away, the dirty rows are merged and drawn by term_check_timers() when
+ * the time is up or no more output arrives.
  *
  * When the job ends the text is put in a buffer.  Redrawing then happens from
  * that buffer, attributes come from the scrollback buffer tl_scrollback.
@@ -59,13 +62,26 @@ typedef struct {
   VTermColor		bg;
 } cellattr_T;
 
+// A run of cells with the same attributes in a scrollback line.
+typedef struct {
+    int		sr_col;		// column of the first cell in the run
+    cellattr_T	sr_attr;
+} sb_run_T;
+
 typedef struct sb_line_S {
     int		sb_cols;	// can differ per line
-    cellattr_T	*sb_cells;	// allocated
+    int		sb_run_count;	// number of items in sb_runs
+    sb_run_T	*sb_runs;	// allocated, ordered by column
     cellattr_T	sb_fill_attr;	// for short line
     char_u	*sb_text;	// for tl_scrollback_postponed
+    int		sb_size;	// bytes used, see SB_LINE_SIZE()
 } sb_line_T;
 
+// Number of bytes used for scrollback line "line" with "text_len" bytes of
+// text, counted against 'maxmem'.
+#define SB_LINE_SIZE(line, text_len) ((int)sizeof(sb_line_T) \
+	+ (line)->sb_run_count * (int)sizeof(sb_run_T) + (text_len) + 1)
+
 #ifdef MSWIN
 # ifndef HPCON
 #  define HPCON VOID*
@@ -140,12 +156,17 @@ struct terminal_S {
 #ifdef FEAT_TIMERS
     int		tl_timer_set;
     proftime_T	tl_timer_due;
+    int		tl_redraw_pending;  // output not drawn yet
+    int		tl_redraw_busy;	    // output since last term_check_timers()
+    proftime_T	tl_redraw_due;	    // when the next redraw may happen
 #endif
     int		tl_postponed_scroll;	/* to be scrolled up */
 
     garray_T	tl_scrollback;
     int		tl_scrollback_scrolled;
+    long_u	tl_scrollback_size;	    // sum of sb_size in tl_scrollback
     garray_T	tl_scrollback_postponed;
+    long_u	tl_scrollback_postponed_size;
 
     cellattr_T	tl_default_color;
 
@@ -856,11 +877,16 @@ free_scrollback(term_T *term)
     int i;
 
     for (i = 0; i < term->tl_scrollback.ga_len; ++i)
-	vim_free(((sb_line_T *)term->tl_scrollback.ga_data + i)->sb_cells);
+	vim_free(((sb_line_T *)term->tl_scrollback.ga_data + i)->sb_runs);
     ga_clear(&term->tl_scrollback);
+    term->tl_scrollback_size = 0;
     for (i = 0; i < term->tl_scrollback_postponed.ga_len; ++i)
-	vim_free(((sb_line_T *)term->tl_scrollback_postponed.ga_data + i)->sb_cells);
+    {
+	vim_free(((sb_line_T *)term->tl_scrollback_postponed.ga_data + i)->sb_runs);
+	vim_free(((sb_line_T *)term->tl_scrollback_postponed.ga_data + i)->sb_text);
+    }
     ga_clear(&term->tl_scrollback_postponed);
+    term->tl_scrollback_postponed_size = 0;
 }
 
 
@@ -1017,6 +1043,34 @@ update_cursor(term_T *term, int redraw)
     }
 }
 
+/*
+ * Update the screen for output of the job in terminal "term".
+ */
+    static void
+update_term_output(term_T *term)
+{
+    buf_T	*buffer = term->tl_buffer;
+
+#ifdef FEAT_TIMERS
+    term->tl_redraw_pending = FALSE;
+    profile_setlimit(p_twu, &term->tl_redraw_due);
+#endif
+
+    // Don't use update_screen() when editing the command line, it gets
+    // cleared.
+    ch_log(term->tl_job->jv_channel, "updating screen");
+    if (buffer == curbuf && (State & CMDLINE) == 0)
+    {
+	update_screen(VALID_NO_UPDATE);
+	/* update_screen() can be slow, check the terminal wasn't closed
+	 * already */
+	if (buffer == curbuf && curbuf->b_term != NULL)
+	    update_cursor(curbuf->b_term, TRUE);
+    }
+    else
+	redraw_after_callback(TRUE);
+}
+
 /*
  * Invoked when "msg" output from a job was received.  Write it to the terminal
  * of "buffer".
@@ -1059,20 +1113,23 @@ write_to_term(buf_T *buffer, char_u *msg, channel_T *channel)
      * contents, thus no screen update is needed. */
     if (!term->tl_normal_mode)
     {
-	// Don't use update_screen() when editing the command line, it gets
-	// cleared.
-	// TODO: only update once in a while.
-	ch_log(term->tl_job->jv_channel, "updating screen");
-	if (buffer == curbuf && (State & CMDLINE) == 0)
+#ifdef FEAT_TIMERS
+	// When the screen was updated less than 'termwinupdate' msec ago,
+	// leave it to term_check_timers().
+	if (p_twu > 0)
 	{
-	    update_screen(VALID_NO_UPDATE);
-	    /* update_screen() can be slow, check the terminal wasn't closed
-	     * already */
-	    if (buffer == curbuf && curbuf->b_term != NULL)
-		update_cursor(curbuf->b_term, TRUE);
+	    proftime_T	now;
+
+	    profile_start(&now);
+	    if (proftime_time_left(&term->tl_redraw_due, &now) > 0)
+	    {
+		term->tl_redraw_pending = TRUE;
+		term->tl_redraw_busy = TRUE;
+		return;
+	    }
 	}
-	else
-	    redraw_after_callback(TRUE);
+#endif
+	update_term_output(term);
     }
 }
 
@@ -1509,6 +1566,96 @@ cell2cellattr(const VTermScreenCell *cell, cellattr_T *attr)
     attr->bg = cell->bg;
 }
 
+/*
+ * Return TRUE if "a" and "b" are exactly the same, including the ANSI color
+ * index and the width.
+ */
+    static int
+same_cellattr(cellattr_T *a, cellattr_T *b)
+{
+    return a->width == b->width
+	&& a->attrs.bold == b->attrs.bold
+	&& a->attrs.underline == b->attrs.underline
+	&& a->attrs.italic == b->attrs.italic
+	&& a->attrs.blink == b->attrs.blink
+	&& a->attrs.reverse == b->attrs.reverse
+	&& a->attrs.strike == b->attrs.strike
+	&& a->attrs.font == b->attrs.font
+	&& a->attrs.dwl == b->attrs.dwl
+	&& a->attrs.dhl == b->attrs.dhl
+	&& a->fg.red == b->fg.red
+	&& a->fg.green == b->fg.green
+	&& a->fg.blue == b->fg.blue
+	&& a->fg.ansi_index == b->fg.ansi_index
+	&& a->bg.red == b->bg.red
+	&& a->bg.green == b->bg.green
+	&& a->bg.blue == b->bg.blue
+	&& a->bg.ansi_index == b->bg.ansi_index;
+}
+
+/*
+ * Store the attributes of the "len" cells in "cells" in scrollback line
+ * "line", as runs of cells with the same attributes.
+ * Returns FAIL when out of memory, "line" then has no cells.
+ */
+    static int
+sb_line_set_cells(sb_line_T *line, cellattr_T *cells, int len)
+{
+    int		count = 0;
+    int		col;
+    sb_run_T	*run;
+
+    line->sb_cols = 0;
+    line->sb_run_count = 0;
+    line->sb_runs = NULL;
+    for (col = 0; col < len; ++col)
+	if (col == 0 || !same_cellattr(&cells[col], &cells[col - 1]))
+	    ++count;
+    if (count == 0)
+	return OK;
+    line->sb_runs = ALLOC_MULT(sb_run_T, count);
+    if (line->sb_runs == NULL)
+	return FAIL;
+
+    run = line->sb_runs;
+    for (col = 0; col < len; ++col)
+	if (col == 0 || !same_cellattr(&cells[col], &cells[col - 1]))
+	{
+	    run->sr_col = col;
+	    run->sr_attr = cells[col];
+	    ++run;
+	}
+    line->sb_cols = len;
+    line->sb_run_count = count;
+    return OK;
+}
+
+/*
+ * Return the attributes of cell "col" in scrollback line "line".  For a
+ * negative "col" or one after the end of the line this is the filler.
+ */
+    static cellattr_T *
+sb_line_get_attr(sb_line_T *line, int col)
+{
+    int		lo = 0;
+    int		hi = line->sb_run_count - 1;
+
+    if (col < 0 || col >= line->sb_cols || hi < 0)
+	return &line->sb_fill_attr;
+
+    // Find the last run that starts at or before "col".
+    while (lo < hi)
+    {
+	int mid = (lo + hi + 1) / 2;
+
+	if (line->sb_runs[mid].sr_col <= col)
+	    lo = mid;
+	else
+	    hi = mid - 1;
+    }
+    return &line->sb_runs[lo].sr_attr;
+}
+
     static int
 equal_celattr(cellattr_T *a, cellattr_T *b)
 {
@@ -1544,8 +1691,12 @@ add_empty_scrollback(term_T *term, cellattr_T *fill_attr, int lnum)
 	    }
 	}
 	line->sb_cols = 0;
-	line->sb_cells = NULL;
+	line->sb_run_count = 0;
+	line->sb_runs = NULL;
 	line->sb_fill_attr = *fill_attr;
+	line->sb_text = NULL;
+	line->sb_size = SB_LINE_SIZE(line, 0);
+	term->tl_scrollback_size += line->sb_size;
 	++term->tl_scrollback.ga_len;
 	return OK;
     }
@@ -1570,7 +1721,8 @@ cleanup_scrollback(term_T *term)
     {
 	ml_delete(curbuf->b_ml.ml_line_count, FALSE);
 	line = (sb_line_T *)gap->ga_data + gap->ga_len - 1;
-	vim_free(line->sb_cells);
+	vim_free(line->sb_runs);
+	term->tl_scrollback_size -= line->sb_size;
 	--gap->ga_len;
     }
     curbuf = curwin->w_buffer;
@@ -1655,6 +1807,10 @@ update_snapshot(term_T *term)
 			width = cell.width;
 
 			cell2cellattr(&cell, &p[pos.col]);
+			// The right half of a double-width character gets the
+			// same attributes, so that it's in the same run.
+			if (width == 2 && pos.col + 1 < len)
+			    p[pos.col + 1] = p[pos.col];
 
 			// Each character can be up to 6 bytes.
 			if (ga_grow(&ga, VTERM_MAX_CHARS_PER_CELL * 6) == OK)
@@ -1668,19 +1824,25 @@ update_snapshot(term_T *term)
 			}
 		    }
 		}
-		line->sb_cols = len;
-		line->sb_cells = p;
+		sb_line_set_cells(line, p, len);
+		vim_free(p);
 		line->sb_fill_attr = new_fill_attr;
+		line->sb_text = NULL;
 		fill_attr = new_fill_attr;
 		++term->tl_scrollback.ga_len;
 
 		if (ga_grow(&ga, 1) == FAIL)
+		{
+		    ga.ga_len = 0;
 		    add_scrollback_line_to_buffer(term, (char_u *)"", 0);
+		}
 		else
 		{
 		    *((char_u *)ga.ga_data + ga.ga_len) = NUL;
 		    add_scrollback_line_to_buffer(term, ga.ga_data, ga.ga_len);
 		}
+		line->sb_size = SB_LINE_SIZE(line, ga.ga_len);
+		term->tl_scrollback_size += line->sb_size;
 		ga_clear(&ga);
 	    }
 	    else
@@ -1750,7 +1912,7 @@ may_move_terminal_to_buffer(term_T *term, int redraw)
 #if defined(FEAT_TIMERS) || defined(PROTO)
 /*
  * Check if any terminal timer expired.  If so, copy text from the terminal to
- * the buffer.
+ * the buffer or draw output that was held back.
  * Return the time until the next timer will expire.
  */
     int
@@ -1773,6 +1935,18 @@ term_check_timers(int next_due_arg, proftime_T *now)
 	    else if (next_due == -1 || next_due > this_due)
 		next_due = this_due;
 	}
+	if (term->tl_redraw_pending && !term->tl_normal_mode)
+	{
+	    long    this_due = proftime_time_left(&term->tl_redraw_due, now);
+
+	    // Also draw when no output arrived since the previous check, the
+	    // job is idle then.
+	    if (this_due <= 1 || !term->tl_redraw_busy)
+		update_term_output(term);
+	    else if (next_due == -1 || next_due > this_due)
+		next_due = this_due;
+	    term->tl_redraw_busy = FALSE;
+	}
     }
 
     return next_due;
@@ -1961,9 +2135,16 @@ send_keys_to_term(term_T *term, int c, int typed)
     /* Convert the typed key to a sequence of bytes for the job. */
     len = term_convert_key(term, c, msg);
     if (len > 0)
+    {
+#ifdef FEAT_TIMERS
+	// Show the response to a typed key without delay.
+	if (typed)
+	    profile_zero(&term->tl_redraw_due);
+#endif
 	/* TODO: if FAIL is returned, stop? */
 	channel_send(term->tl_job->jv_channel, get_tty_part(term),
 						(char_u *)msg, (int)len, NULL);
+    }
 
     return OK;
 }
@@ -2803,23 +2984,38 @@ handle_resize(int rows, int cols, void *user)
 }
 
 /*
- * If the number of lines that are stored goes over 'termscrollback' then
- * delete the first 10%.
+ * If the number of lines that are stored goes over 'termwinscroll' then
+ * delete the first 10%.  Also when the memory used goes over 'maxmem'.
  * "gap" points to tl_scrollback or tl_scrollback_postponed.
  * "update_buffer" is TRUE when the buffer should be updated.
  */
     static void
 limit_scrollback(term_T *term, garray_T *gap, int update_buffer)
 {
+    long_u	*sizep = gap == &term->tl_scrollback
+		    ? &term->tl_scrollback_size
+		    : &term->tl_scrollback_postponed_size;
+    int		todo = 0;
+
     if (gap->ga_len >= term->tl_buffer->b_p_twsl)
+	todo = term->tl_buffer->b_p_twsl / 10;
+    else if (*sizep > (long_u)p_mm * 1024L)
+	todo = gap->ga_len / 10 + 1;
+    if (todo > gap->ga_len)
+	todo = gap->ga_len;
+
+    if (todo > 0)
     {
-	int	todo = term->tl_buffer->b_p_twsl / 10;
 	int	i;
 
 	curbuf = term->tl_buffer;
 	for (i = 0; i < todo; ++i)
 	{
-	    vim_free(((sb_line_T *)gap->ga_data + i)->sb_cells);
+	    sb_line_T *line = (sb_line_T *)gap->ga_data + i;
+
+	    vim_free(line->sb_runs);
+	    vim_free(line->sb_text);
+	    *sizep -= line->sb_size;
 	    if (update_buffer)
 		ml_delete(1, FALSE);
 	}
@@ -2898,6 +3094,10 @@ handle_pushline(int cols, const VTermScreenCell *cells, void *user)
 		    ga.ga_len += utf_char2bytes(c == NUL ? ' ' : c,
 					     (char_u *)ga.ga_data + ga.ga_len);
 		cell2cellattr(&cells[col], &p[col]);
+		// The right half of a double-width character gets the same
+		// attributes, so that it's in the same run.
+		if (cells[col].width == 2 && col + 1 < len)
+		    p[col + 1] = p[col];
 	    }
 	}
 	if (ga_grow(&ga, 1) == FAIL)
@@ -2918,18 +3118,21 @@ handle_pushline(int cols, const VTermScreenCell *cells, void *user)
 	    add_scrollback_line_to_buffer(term, text, text_len);
 
 	line = (sb_line_T *)gap->ga_data + gap->ga_len;
-	line->sb_cols = len;
-	line->sb_cells = p;
+	sb_line_set_cells(line, p, len);
+	vim_free(p);
 	line->sb_fill_attr = fill_attr;
+	line->sb_size = SB_LINE_SIZE(line, text_len);
 	if (update_buffer)
 	{
 	    line->sb_text = NULL;
 	    ++term->tl_scrollback_scrolled;
+	    term->tl_scrollback_size += line->sb_size;
 	    ga_clear(&ga);  // free the text
 	}
 	else
 	{
 	    line->sb_text = text;
+	    term->tl_scrollback_postponed_size += line->sb_size;
 	    ga_init(&ga);  // text is kept in tl_scrollback_postponed
 	}
 	++gap->ga_len;
@@ -2972,15 +3175,15 @@ handle_postponed_scrollback(term_T *term)
 
 	line = (sb_line_T *)term->tl_scrollback.ga_data
 						 + term->tl_scrollback.ga_len;
-	line->sb_cols = pp_line->sb_cols;
-	line->sb_cells = pp_line->sb_cells;
-	line->sb_fill_attr = pp_line->sb_fill_attr;
+	*line = *pp_line;
 	line->sb_text = NULL;
+	term->tl_scrollback_size += line->sb_size;
 	++term->tl_scrollback_scrolled;
 	++term->tl_scrollback.ga_len;
     }
 
     ga_clear(&term->tl_scrollback_postponed);
+    term->tl_scrollback_postponed_size = 0;
     limit_scrollback(term, &term->tl_scrollback, TRUE);
 }
 
@@ -3424,19 +3627,13 @@ term_change_in_curbuf(void)
 term_get_attr(buf_T *buf, linenr_T lnum, int col)
 {
     term_T	*term = buf->b_term;
-    sb_line_T	*line;
     cellattr_T	*cellattr;
 
     if (lnum > term->tl_scrollback.ga_len)
 	cellattr = &term->tl_default_color;
     else
-    {
-	line = (sb_line_T *)term->tl_scrollback.ga_data + lnum - 1;
-	if (col < 0 || col >= line->sb_cols)
-	    cellattr = &line->sb_fill_attr;
-	else
-	    cellattr = line->sb_cells + col;
-    }
+	cellattr = sb_line_get_attr(
+		      (sb_line_T *)term->tl_scrollback.ga_data + lnum - 1, col);
     return cell2attr(cellattr->attrs, cellattr->fg, cellattr->bg);
 }
 
@@ -4376,11 +4573,13 @@ read_dump_file(FILE *fd, VTermPos *cursor_pos)
 
 		if (max_cells < ga_cell.ga_len)
 		    max_cells = ga_cell.ga_len;
-		line->sb_cols = ga_cell.ga_len;
-		line->sb_cells = ga_cell.ga_data;
+		sb_line_set_cells(line, ga_cell.ga_data, ga_cell.ga_len);
 		line->sb_fill_attr = term->tl_default_color;
+		line->sb_text = NULL;
+		line->sb_size = SB_LINE_SIZE(line, ga_text.ga_len);
+		term->tl_scrollback_size += line->sb_size;
 		++term->tl_scrollback.ga_len;
-		ga_init(&ga_cell);
+		ga_clear(&ga_cell);
 
 		ga_append(&ga_text, NUL);
 		ml_append(curbuf->b_ml.ml_line_count, ga_text.ga_data,
@@ -4769,9 +4968,8 @@ term_load_dump(typval_T *argvars, typval_T *rettv, int do_diff)
 		char_u *p2;
 		int	col;
 		sb_line_T   *sb_line = (sb_line_T *)term->tl_scrollback.ga_data;
-		cellattr_T *cellattr1 = (sb_line + lnum - 1)->sb_cells;
-		cellattr_T *cellattr2 = (sb_line + lnum + bot_lnum - 1)
-								    ->sb_cells;
+		sb_line_T   *sb_line1 = sb_line + lnum - 1;
+		sb_line_T   *sb_line2 = sb_line + lnum + bot_lnum - 1;
 
 		/* Make a copy, getting the second line will invalidate it. */
 		line1 = vim_strsave(ml_get(lnum));
@@ -4802,19 +5000,20 @@ term_load_dump(typval_T *argvars, typval_T *rettv, int do_diff)
 					|| cursor_pos1.col != cursor_pos2.col))
 			/* cursor in second but not in first */
 			textline[col] = '<';
-		    else if (cellattr1 != NULL && cellattr2 != NULL)
+		    else if (sb_line1->sb_run_count > 0
+					       && sb_line2->sb_run_count > 0)
 		    {
-			if ((cellattr1 + col)->width
-						   != (cellattr2 + col)->width)
+			cellattr_T *cellattr1 = sb_line_get_attr(sb_line1, col);
+			cellattr_T *cellattr2 = sb_line_get_attr(sb_line2, col);
+
+			if (cellattr1->width != cellattr2->width)
 			    textline[col] = 'w';
-			else if (!same_color(&(cellattr1 + col)->fg,
-						   &(cellattr2 + col)->fg))
+			else if (!same_color(&cellattr1->fg, &cellattr2->fg))
 			    textline[col] = 'f';
-			else if (!same_color(&(cellattr1 + col)->bg,
-						   &(cellattr2 + col)->bg))
+			else if (!same_color(&cellattr1->bg, &cellattr2->bg))
 			    textline[col] = 'b';
-			else if (vtermAttr2hl((cellattr1 + col)->attrs)
-				   != vtermAttr2hl(((cellattr2 + col)->attrs)))
+			else if (vtermAttr2hl(cellattr1->attrs)
+					       != vtermAttr2hl(cellattr2->attrs))
 			    textline[col] = 'a';
 		    }
 		    p1 += len1;
@@ -5374,7 +5573,7 @@ f_term_scrape(typval_T *argvars, typval_T *rettv)
 	    /* vterm has finished, get the cell from scrollback */
 	    if (pos.col >= line->sb_cols)
 		break;
-	    cellattr = line->sb_cells + pos.col;
+	    cellattr = sb_line_get_attr(line, pos.col);
 	    width = cellattr->width;
 	    attrs = cellattr->attrs;
 	    fg = cellattr->fg;
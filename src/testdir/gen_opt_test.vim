@@ -47,9 +47,12 @@ let test_values = {
       \ 'sidescroll': [[0, 1, 8, 999], [-1]],
       \ 'sidescrolloff': [[0, 1, 8, 999], [-1]],
       \ 'tabstop': [[1, 4, 8, 12], [-1, 0]],
+      \ 'tagcache': [[0, 1, 1000], [-1]],
+      \ 'termwinupdate': [[0, 1, 20, 1000], [-1]],
       \ 'textwidth': [[0, 1, 8, 99], [-1]],
       \ 'timeoutlen': [[0, 8, 99999], [-1]],
       \ 'titlelen': [[0, 1, 8, 9999], [-1]],
+      \ 'undomaxmem': [[0, 1, 100], [-1]],
       \ 'updatecount': [[0, 1, 8, 9999], [-1]],
       \ 'updatetime': [[0, 1, 8, 9999], [-1]],
       \ 'verbose': [[-1, 0, 1, 8, 9999], []],
@@ -126,7 +129,7 @@ let test_values = {
       \ 'signcolumn': [['', 'auto', 'no'], ['xxx', 'no,yes']],
       \ 'spellfile': [['', 'file.en.add'], ['xxx', '/tmp/file']],
       \ 'spelllang': [['', 'xxx', 'sr@latin'], ['not&lang', "that\\\rthere"]],
-      \ 'spellsuggest': [['', 'best', 'double,33'], ['xxx']],
+      \ 'spellsuggest': [['', 'best', 'double,33', 'fast,timeout:100'], ['xxx', 'timeout:x', 'timeout:']],
       \ 'switchbuf': [['', 'useopen', 'split,newtab'], ['xxx']],
       \ 'tagcase': [['smart', 'match'], ['', 'xxx', 'smart,match']],
       \ 'term': [[], []],
@@ -929,3 +929,141 @@ func Test_diff_of_diff()
   call StopVimInTerminal(buf)
   call delete('Xtest_diff_diff')
 endfunc
+
+func Test_diff_fold_many_blocks()
+  enew!
+  let l = range(1, 200)
+  call setline(1, l)
+  diffthis
+  let winone = win_getid()
+  new
+  for i in [20, 80, 83, 150]
+    let l[i - 1] = 'diff' . i
+  endfor
+  call setline(1, l)
+  diffthis
+  call assert_equal(1, foldclosed(5))
+  call assert_equal(13, foldclosedend(5))
+  call assert_equal(-1, foldclosed(17))
+  call assert_equal(27, foldclosed(50))
+  call assert_equal(73, foldclosedend(50))
+  call assert_equal(-1, foldclosed(81))
+  call assert_equal(90, foldclosed(100))
+  call assert_equal(143, foldclosedend(100))
+  call assert_equal(157, foldclosed(200))
+
+  " folds follow when a diff block goes away and when the context changes
+  80
+  diffget
+  call assert_equal(-1, foldclosed(83))
+  call assert_equal(27, foldclosed(70))
+  call assert_equal(76, foldclosedend(70))
+  set diffopt+=context:2
+  call assert_equal(23, foldclosed(50))
+  call assert_equal(80, foldclosedend(50))
+  call assert_equal(-1, foldclosed(82))
+  call assert_equal(86, foldclosed(100))
+
+  " folds follow inserted lines
+  call append(10, ['new1', 'new2'])
+  diffupdate
+  call assert_equal(-1, foldclosed(11))
+  call assert_equal(1, foldclosed(5))
+  call assert_equal(8, foldclosedend(5))
+
+  set diffopt&
+  windo diffoff
+  close!
+  bwipe!
+endfunc
+
+func Test_diff_update_changed_lines()
+  let l = range(1, 100)
+  call setline(1, l)
+  diffthis
+  vnew
+  let l[9] = 'ten'
+  let l[89] = 'ninety'
+  call setline(1, l)
+  diffthis
+  call assert_equal(hlID('DiffText'), diff_hlID(10, 1))
+  call assert_equal(hlID('DiffText'), diff_hlID(90, 1))
+
+  " changing a line between the diff blocks only adds a block there
+  call setline(50, 'fifty')
+  call append(60, ['new1', 'new2'])
+  call assert_equal(hlID('DiffText'), diff_hlID(10, 1))
+  call assert_equal(hlID('DiffText'), diff_hlID(50, 1))
+  call assert_equal(0, diff_hlID(49, 1))
+  call assert_equal(0, diff_hlID(51, 1))
+  call assert_equal(hlID('DiffAdd'), diff_hlID(61, 1))
+  call assert_equal(hlID('DiffAdd'), diff_hlID(62, 1))
+  call assert_equal(0, diff_hlID(63, 1))
+  call assert_equal(hlID('DiffText'), diff_hlID(92, 1))
+  wincmd w
+  call assert_equal(2, diff_filler(61))
+
+  " undoing a change inside a diff block removes the block
+  wincmd w
+  call setline(10, '10')
+  61,62delete
+  call assert_equal(0, diff_hlID(10, 1))
+  call assert_equal(0, diff_hlID(61, 1))
+  call assert_equal(hlID('DiffText'), diff_hlID(50, 1))
+  wincmd w
+  call assert_equal(0, diff_filler(61))
+
+  " the result matches a complete update
+  let hl = map(range(1, 100), 'diff_hlID(v:val, 1)')
+  diffupdate
+  call assert_equal(hl, map(range(1, 100), 'diff_hlID(v:val, 1)'))
+
+  windo diffoff
+  bwipe!
+  enew!
+endfunc
+
+func Test_diff_line_hash_cache()
+  call setline(1, ['one', 'Two', 'three  3', 'four', 'five'])
+  diffthis
+  vnew
+  call setline(1, ['one', 'two', 'three 3', 'four', 'five'])
+  diffthis
+  call assert_equal(hlID('DiffText'), diff_hlID(2, 1))
+  call assert_equal(hlID('DiffChange'), diff_hlID(3, 1))
+
+  " the line hashes depend on 'diffopt'
+  set diffopt+=icase
+  call assert_equal(0, diff_hlID(2, 1))
+  call assert_equal(hlID('DiffChange'), diff_hlID(3, 1))
+  set diffopt-=icase
+  call assert_equal(hlID('DiffText'), diff_hlID(2, 1))
+  set diffopt+=iwhite
+  call assert_equal(hlID('DiffText'), diff_hlID(2, 1))
+  call assert_equal(0, diff_hlID(3, 1))
+  set diffopt&
+  " diff_hlID() caches the result for the last line
+  call assert_equal(0, diff_hlID(1, 1))
+  call assert_equal(hlID('DiffChange'), diff_hlID(3, 1))
+
+  " changed, inserted and deleted lines get new hashes
+  call setline(4, 'FOUR')
+  diffupdate
+  call assert_equal(hlID('DiffText'), diff_hlID(4, 1))
+  call setline(4, 'four')
+  call append(0, 'zero')
+  diffupdate
+  call assert_equal(hlID('DiffAdd'), diff_hlID(1, 1))
+  call assert_equal(0, diff_hlID(5, 1))
+  1delete
+  2
+  normal! dd
+  call append(1, 'Two')
+  diffupdate
+  call assert_equal(0, diff_hlID(2, 1))
+  call assert_equal(hlID('DiffChange'), diff_hlID(3, 1))
+
+  windo diffoff
+  bwipe!
+  enew!
+endfunc
@@ -606,3 +606,29 @@ func Test_setfiletype_completion()
   call feedkeys(":setfiletype java\<C-A>\<C-B>\"\<CR>", 'tx')
   call assert_equal('"setfiletype java javacc javascript', @:)
 endfunc
+
+" Autocommand patterns, like the many ones in filetype.vim, are compiled when
+" first used.  An invalid pattern is still rejected when it is defined, and
+" 'cpoptions' is used as it was then.
+func Test_autocmd_pattern_checked()
+  augroup testing
+    call assert_fails('au BufRead Xa\( let g:matched = 1', 'E54:')
+  augroup END
+  call assert_notmatch('Xa', execute('au testing BufRead'))
+  new Xa(
+  call assert_false(exists('g:matched'))
+  bwipe!
+
+  let save_cpo = &cpo
+  set cpo+=l
+  au testing User Xcpo[\t] let g:matched = 1
+  let &cpo = save_cpo
+  doautocmd User Xcpo\
+  call assert_true(exists('g:matched'))
+  unlet g:matched
+  exe "doautocmd User Xcpo\t"
+  call assert_false(exists('g:matched'))
+
+  au! testing
+  augroup! testing
+endfunc
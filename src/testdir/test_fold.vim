@@ -742,3 +742,94 @@ func Test_folds_marker_in_comment2()
   set foldmethod&
   bwipe!
 endfunc
+
+func FoldExprCount(lnum)
+  let g:fold_expr_count += 1
+  return getline(a:lnum) =~ '^#' ? '>1' : '='
+endfunc
+
+func s:ClosedFold(lnum)
+  setlocal foldlevel=0
+  let r = [foldclosed(a:lnum), foldclosedend(a:lnum)]
+  setlocal foldlevel=9
+  return r
+endfunc
+
+" Only the lines around a change are evaluated again.
+func Test_foldexpr_incremental()
+  new
+  call setline(1, ['# one'] + repeat(['text'], 999) + ['# two'] + repeat(['text'], 999))
+  let g:fold_expr_count = 0
+  setlocal foldmethod=expr foldexpr=FoldExprCount(v:lnum) foldlevel=9
+  call assert_equal([1, 1000], s:ClosedFold(1))
+  call assert_true(g:fold_expr_count >= 2000)
+
+  let g:fold_expr_count = 0
+  500
+  normal! Ax
+  call assert_inrange(1, 10, g:fold_expr_count)
+  let g:fold_expr_count = 0
+  normal! oy
+  normal! dd
+  call assert_inrange(1, 20, g:fold_expr_count)
+  call assert_equal([1, 1000], s:ClosedFold(500))
+  call assert_equal([1001, 2000], s:ClosedFold(1500))
+
+  " Starting a new fold splits the existing one.
+  500
+  normal! cc# three
+  call assert_equal([1, 499], s:ClosedFold(499))
+  call assert_equal([500, 1000], s:ClosedFold(500))
+  call assert_equal([1001, 2000], s:ClosedFold(1500))
+
+  " The cached levels are also valid in a new window.
+  split
+  let g:fold_expr_count = 0
+  normal! dd
+  call assert_inrange(1, 10, g:fold_expr_count)
+  call assert_equal([1, 999], s:ClosedFold(500))
+  call assert_equal([1000, 1999], s:ClosedFold(1500))
+  close
+
+  let g:fold_expr_count = 0
+  normal! zx
+  call assert_equal([1, 999], s:ClosedFold(500))
+  call assert_equal([1000, 1999], s:ClosedFold(1500))
+  call assert_true(g:fold_expr_count >= 1999)
+
+  unlet g:fold_expr_count
+  bwipe!
+endfunc
+
+func Test_fold_lazy()
+  new
+  call setline(1, repeat(['# head'] + repeat(['text'], 9), 1000))
+  let g:fold_expr_count = 0
+  setlocal foldmethod=expr foldexpr=FoldExprCount(v:lnum) foldlevel=0
+  " Only the folds at the top are computed.
+  call assert_equal([1, 10], [foldclosed(5), foldclosedend(5)])
+  call assert_inrange(1, 2000, g:fold_expr_count)
+  " A fold further down is computed when it is used.
+  call assert_equal([9991, 10000], [foldclosed(9995), foldclosedend(9995)])
+  call assert_equal([5001, 5010], [foldclosed(5005), foldclosedend(5005)])
+  call assert_true(g:fold_expr_count >= 10000)
+
+  " Switching to manual folding keeps all the folds.
+  setlocal foldexpr=FoldExprCount(v:lnum)
+  call assert_equal(1, foldclosed(1))
+  setlocal foldmethod=manual
+  call assert_equal([9991, 10000], [foldclosed(9995), foldclosedend(9995)])
+
+  if has('timers')
+    " The rest is computed while waiting.
+    setlocal foldmethod=expr
+    call assert_equal(1, foldclosed(1))
+    sleep 200m
+    let g:fold_expr_count = 0
+    call assert_equal([9991, 10000], [foldclosed(9995), foldclosedend(9995)])
+    call assert_equal(0, g:fold_expr_count)
+  endif
+
+  unlet g:fold_expr_count
+  bwipe!
+endfunc
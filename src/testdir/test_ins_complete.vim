@@ -1,4 +1,6 @@
 
+
+source screendump.vim
 " Test for insert expansion
 func Test_ins_complete()
   edit test_ins_complete.vim
@@ -313,3 +315,130 @@ func Test_compl_feedkeys()
   bwipe!
   set completeopt&
 endfunc
+
+func s:CompleteItems()
+  let s:items = map(copy(complete_info(['items']).items), 'v:val.word')
+  return ''
+endfunc
+
+" Words in other buffers are found with a word index, which must be updated
+" when the buffer changes.
+func Test_compl_other_buffer_words()
+  new
+  call setline(1, ['foobar fooqux', 'food foobar', 'f x fo'])
+  let other = bufnr('')
+  new
+  set complete=w
+  inoremap <buffer> <F5> <C-R>=<SID>CompleteItems()<CR>
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foobar', 'fooqux', 'food'], s:items)
+
+  call setbufline(other, 1, 'foolish fooqux')
+  call deletebufline(other, 2)
+  call appendbufline(other, 1, ['foolproof'])
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foolish', 'fooqux', 'foolproof'], s:items)
+
+  " changing text in the other window
+  wincmd j
+  call setline(2, 'football')
+  normal! 1Gdd
+  wincmd k
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['football'], s:items)
+
+  " a one character leader
+  call feedkeys("Sf\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['football', 'fo'], s:items)
+
+  " changing text in place in the other window
+  wincmd j
+  call setline(1, ['foobar', 'fooxoobazqq'])
+  wincmd k
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foobar', 'fooxoobazqq'], s:items)
+  wincmd j
+  normal! 1G$rz
+  wincmd k
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foobaz', 'fooxoobazqq'], s:items)
+  wincmd j
+  exe "normal! 2GAq\<Esc>03lx"
+  wincmd k
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foobaz', 'foooobazqqq'], s:items)
+  wincmd j
+  exe "normal! 1G$Rxy\<Esc>"
+  wincmd k
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foobaxy', 'foooobazqqq'], s:items)
+
+  " 'iskeyword' is used
+  call setbufvar(other, '&iskeyword', '@,48-57,_,192-255,-')
+  call setbufline(other, 1, 'foo-bar')
+  setlocal iskeyword=@,48-57,_,192-255,-
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['foo-bar', 'foooobazqqq'], s:items)
+
+  " words that only differ in case, with and without 'ignorecase'
+  call setbufline(other, 1, ['FOObar fooy Fooy', 'fooy xfoo'])
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['fooy'], s:items)
+  set ignorecase
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['FOObar', 'fooy', 'Fooy'], s:items)
+  call deletebufline(other, 1)
+  call feedkeys("Sfoo\<C-N>\<F5>\<Esc>", 'tx')
+  call assert_equal(['fooy'], s:items)
+  set noignorecase
+
+  set complete&
+  bwipe!
+  exe 'bwipe! ' .. other
+endfunc
+
+" When typing, searching for matches stops after a time slice and continues
+" while waiting for the next key.
+func Test_compl_search_more()
+  if !CanRunVimInTerminal() || !has('reltime')
+    throw 'Skipped: cannot run Vim in a terminal window'
+  endif
+  " Finding this many matches takes much longer than a time slice.
+  call writefile(map(range(1, 20000), '"foo" .. v:val'), 'Xcompl')
+  let buf = RunVimInTerminal('Xcompl', {'rows': 10})
+  call term_sendkeys(buf, ":set complete=.\<CR>")
+
+  " The popup menu is shown with the matches found so far, the total number
+  " of matches is not known yet.
+  call term_sendkeys(buf, "Gofoo\<C-N>")
+  call WaitForAssert({-> assert_match('match 1$', term_getline(buf, 10))})
+  call assert_equal('foo1', term_getline(buf, 9))
+  call assert_match('^foo1 *$', term_getline(buf, 1))
+
+  " typing a key while searching selects the next match
+  call term_sendkeys(buf, "\<C-N>")
+  call WaitForAssert({-> assert_equal('foo2', term_getline(buf, 9))})
+  call WaitForAssert({-> assert_match('^foo3 *$', term_getline(buf, 3))})
+
+  " searching continues until all matches are found, in the right order
+  for i in range(100)
+    call term_sendkeys(buf, "\<C-N>\<C-P>")
+    call term_wait(buf, 100)
+    if term_getline(buf, 10) =~ 'match 2 of 20000$'
+      break
+    endif
+  endfor
+  call assert_match('match 2 of 20000$', term_getline(buf, 10))
+  call term_sendkeys(buf, "\<C-N>")
+  call WaitForAssert({-> assert_equal('foo3', term_getline(buf, 9))})
+  call term_sendkeys(buf, "\<C-P>\<C-P>\<C-P>\<C-P>")
+  call WaitForAssert({-> assert_match('match 20000 of 20000$', term_getline(buf, 10))})
+  call assert_equal('foo20000', term_getline(buf, 9))
+
+  " typing text while searching inserts it
+  call term_sendkeys(buf, "\<Esc>ofoo\<C-N>bar\<Esc>")
+  call WaitForAssert({-> assert_equal('foo1bar', term_getline(buf, 9))})
+
+  call StopVimInTerminal(buf)
+  call delete('Xcompl')
+endfunc
@@ -355,3 +355,32 @@ func Test_runtime()
   runtime! ALL extra/bar.vim
   call assert_equal('runstartopt', g:sequence)
 endfunc
+
+func Test_runtime_wildcard()
+  let rundir = &packpath . '/runtime/extra'
+  call mkdir(rundir . '/d.vim', 'p')
+  call writefile(['let g:sequence .= "b"'], rundir . '/b.vim')
+  call writefile(['let g:sequence .= "a"'], rundir . '/a.vim')
+  call writefile(['let g:sequence .= "hidden"'], rundir . '/.c.vim')
+  exe 'set rtp=' . &packpath . '/runtime'
+
+  let g:sequence = ''
+  runtime! extra/*.vim
+  call assert_equal('ab', g:sequence)
+  let g:sequence = ''
+  runtime extra/*.vim
+  call assert_equal('a', g:sequence)
+
+  " Changes in the directory are noticed, also when they happen in the same
+  " second as the directory was read.
+  sleep 1100m
+  runtime! extra/*.vim
+  call writefile(['let g:sequence .= "c"'], rundir . '/c.vim')
+  let g:sequence = ''
+  runtime! extra/*.vim
+  call assert_equal('abc', g:sequence)
+  call delete(rundir . '/a.vim')
+  let g:sequence = ''
+  runtime! extra/*.vim
+  call assert_equal('bc', g:sequence)
+endfunc
@@ -1074,6 +1074,50 @@ func Test_invalid_efm()
   call Xinvalid_efm_Tests('l')
 endfunc
 
+" Test for the literal text at the start of an 'errorformat' part
+func Test_efm_literal_lead()
+  let save_efm = &efm
+  set efm=ERROR\ %f:%l:%m,Warning\ %f\ line\ %l:%m,x%#y\ %f:%l:%m
+  cgetexpr ['error Xfile1:10:first', 'WARNING Xfile2 line 20:second',
+        \ 'some text', 'y Xfile3:30:third', 'xxxy Xfile4:40:fourth',
+        \ 'ERRORS Xfile5:50:none']
+  let l = getqflist()
+  call assert_equal(6, len(l))
+  call assert_equal([1, 10, 'first'], [l[0].valid, l[0].lnum, l[0].text])
+  call assert_equal('Xfile1', bufname(l[0].bufnr))
+  call assert_equal([1, 20, 'second'], [l[1].valid, l[1].lnum, l[1].text])
+  call assert_equal([0, 0, 'some text'], [l[2].valid, l[2].lnum, l[2].text])
+  call assert_equal([1, 30, 'third'], [l[3].valid, l[3].lnum, l[3].text])
+  call assert_equal([1, 40, 'fourth'], [l[4].valid, l[4].lnum, l[4].text])
+  call assert_equal([0, 0, 'ERRORS Xfile5:50:none'],
+        \ [l[5].valid, l[5].lnum, l[5].text])
+
+  " a character followed by %# is optional
+  set efm=%f;%#%l-%m
+  cgetexpr ['Xfile6;12-sixth', 'Xfile7 13-seventh']
+  let l = getqflist()
+  call assert_equal([1, 12, 'sixth'], [l[0].valid, l[0].lnum, l[0].text])
+  call assert_equal([1, 13, 'seventh'], [l[1].valid, l[1].lnum, l[1].text])
+
+  " a line that doesn't match gets no column or type from the previous one
+  set efm=%EE\ %f:%l:%c:%m,%-GX%.%#
+  cgetexpr ['E Xfile1:10:5:first', 'other text']
+  let l = getqflist()
+  call assert_equal([5, 'E'], [l[0].col, l[0].type])
+  call assert_equal([0, 0, ''], [l[1].valid, l[1].col, l[1].type])
+
+  " with an alternation the text before it is not required
+  let &efm = '%-GIgnore %.%#%\|Skip:%.%#,%f:%l:%m'
+  cgetexpr ['Xfile1:10:first', 'Ignore this', 'Skip: that',
+        \ 'Xfile2:20:second']
+  let l = getqflist()
+  call assert_equal(2, len(l))
+  call assert_equal([1, 10, 'first'], [l[0].valid, l[0].lnum, l[0].text])
+  call assert_equal([1, 20, 'second'], [l[1].valid, l[1].lnum, l[1].text])
+
+  let &efm = save_efm
+endfunc
+
 " TODO:
 " Add tests for the following formats in 'errorformat'
 "	%r  %O
@@ -4226,6 +4270,47 @@ func Xtest_below(cchar)
   call delete('X4')
 endfunc
 
+" Test for going to an entry by number in a long list
+func Test_qf_nth_entry()
+  let lines = map(range(1, 3000), '"Xfile" . (v:val % 3) . ":" . v:val . ":m" . v:val')
+  call add(lines, 'Xfile9:7:first')
+  call add(lines, ' second')
+  let save_efm = &efm
+  let &efm = '%A%f:%l:%m,%C %m'
+  cgetexpr lines
+  call assert_equal(3001, getqflist({'size' : 0}).size)
+  call assert_equal('first' . "\n" . 'second', getqflist()[3000].text)
+
+  call setqflist([], 'a', {'idx' : 2500})
+  call assert_equal(2500, getqflist({'idx' : 0}).idx)
+  call setqflist([], 'a', {'idx' : 20})
+  call assert_equal(20, getqflist({'idx' : 0}).idx)
+  call setqflist([], 'a', {'idx' : '$'})
+  call assert_equal(3001, getqflist({'idx' : 0}).idx)
+  call setqflist([], 'a', {'idx' : 9999})
+  call assert_equal(3001, getqflist({'idx' : 0}).idx)
+
+  let l = split(execute('clist 1499,1501'), "\n")
+  call assert_equal(3, len(l))
+  call assert_equal('1499 Xfile2:1499: m1499', l[0])
+  call assert_equal('1501 Xfile1:1501: m1501', l[2])
+  let l = split(execute('clist -2,'), "\n")
+  call assert_equal(2, len(l))
+  call assert_equal('3001 Xfile9:7: first second', l[1])
+
+  " a location list copied to a new window
+  lgetexpr lines
+  call setloclist(0, [], 'a', {'idx' : 1234})
+  split
+  call assert_equal(1234, getloclist(0, {'idx' : 0}).idx)
+  call assert_equal(3001, getloclist(0, {'size' : 0}).size)
+  call assert_equal('m1234', getloclist(0)[1233].text)
+  close
+  call setloclist(0, [], 'f')
+  call setqflist([], 'f')
+  let &efm = save_efm
+endfunc
+
 func Test_cbelow()
   call Xtest_below('c')
   call Xtest_below('l')
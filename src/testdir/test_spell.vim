@@ -27,6 +27,122 @@ func Test_wrap_search()
   set nospell
 endfunc
 
+" The results of checking a line are cached, changes must update the cache.
+func Test_spell_cache_changes()
+  call writefile(['some', 'text', 'a', 'long', 'line', 'more', 'the', 'end',
+        \ 'one', 'two'], 'Xspellcache.words')
+  mkspell! Xspellcache.spl Xspellcache.words
+  new
+  call setline(1, ['some text', 'a plong line', 'more text', 'the end'])
+  set spell spelllang=Xspellcache.spl
+  redraw
+  2
+  call assert_equal(['plong', 'bad'], spellbadword())
+  call setline(2, 'a long line')
+  call assert_equal(['', ''], spellbadword())
+
+  " lines inserted and deleted above
+  call setline(3, 'more zext')
+  redraw
+  3
+  call assert_equal(['zext', 'bad'], spellbadword())
+  call append(1, ['one', 'two'])
+  5
+  call assert_equal(['zext', 'bad'], spellbadword())
+  let &undolevels = &undolevels
+  1,2delete
+  3
+  call assert_equal(['zext', 'bad'], spellbadword())
+  normal! u
+  5
+  call assert_equal(['zext', 'bad'], spellbadword())
+
+  " a word is added to the spell file
+  set spellfile=Xspellcache.add
+  normal! wzg
+  call assert_equal(['', ''], spellbadword())
+  set spellfile&
+
+  " the buffer is reloaded
+  call writefile(['some text', 'a blong line'], 'Xspellcache')
+  exe 'edit! Xspellcache'
+  redraw
+  2
+  call assert_equal(['blong', 'bad'], spellbadword())
+  sleep 1
+  call writefile(['some text', 'a long line'], 'Xspellcache')
+  set autoread
+  checktime
+  2
+  call assert_equal('a long line', getline(2))
+  call assert_equal(['', ''], spellbadword())
+
+  bwipe!
+  set spell& spelllang& autoread&
+  call delete('Xspellcache')
+  call delete('Xspellcache.words')
+  call delete('Xspellcache.spl')
+  call delete('Xspellcache.add')
+  call delete('Xspellcache.add.spl')
+endfunc
+
+func Test_spellsuggest_timeout()
+  call writefile(['some', 'text', 'long', 'line', 'more', 'the', 'end'],
+        \ 'Xspelltime.words')
+  mkspell! Xspelltime.spl Xspelltime.words
+  new
+  set spell spelllang=Xspelltime.spl
+  let expected = spellsuggest('lnog')
+  call assert_equal('long', expected[0])
+
+  " a generous limit finds the same suggestions
+  set spellsuggest=best,timeout:10000
+  call assert_equal(expected, spellsuggest('lnog'))
+
+  " without a method the default is used
+  set spellsuggest=timeout:10000
+  call assert_equal(expected, spellsuggest('lnog'))
+  set spellsuggest=timeout:10000,5
+  call assert_equal(expected[:4], spellsuggest('lnog'))
+
+  call assert_fails('set spellsuggest=best,timeout:', 'E474:')
+  call assert_fails('set spellsuggest=timeout:1x', 'E474:')
+
+  if has('reltime')
+    " many similar words, finding them all takes much longer than the limit
+    let chars = split('abcdefghijklmnopqrstuvwxyz', '\zs')
+    let words = []
+    for i in range(50000)
+      let w = ''
+      let n = i
+      for j in range(6)
+        let w .= chars[n % 26]
+        let n = n / 26 + j * 7
+      endfor
+      call add(words, w)
+    endfor
+    call writefile(words, 'Xspelltime.words')
+    mkspell! Xspelltime.spl Xspelltime.words
+    set spellsuggest=best
+    let all = spellsuggest('xqzabc', 100)
+    call assert_equal(100, len(all))
+
+    " when the time runs out the suggestions found so far are returned
+    set spellsuggest=best,timeout:1
+    let found = spellsuggest('xqzabc', 100)
+    call assert_true(len(found) > 0)
+    call assert_true(len(found) < len(all))
+    for word in found
+      call assert_true(index(words, word) >= 0, word)
+    endfor
+  endif
+
+  bwipe!
+  set spell& spelllang& spellsuggest&
+  call delete('Xspelltime.words')
+  call delete('Xspelltime.spl')
+endfunc
+
 func Test_curswant()
   new
   call setline(1, ['Another plong line', 'abcdefghijklmnopq'])
@@ -375,6 +491,103 @@ func Test_zz_sal_and_addition()
   call assert_equal("elekwint", SecondSpellWord())
 endfunc
 
+" The .spl file has the word trees in a form that is mapped into memory.
+func Test_spell_image()
+  call writefile(['one', 'two', 'three'], 'Xwords')
+  mkspell! Xwords.spl Xwords
+  set spelllang=Xwords.spl spell
+  call assert_equal(['four', 'bad'], spellbadword('one two four'))
+
+  " Write the file again while it is in use.
+  call writefile(['one', 'two', 'four'], 'Xwords')
+  mkspell! Xwords.spl Xwords
+  call assert_false(filereadable('Xwords.spl.tmp'))
+  call assert_equal(['three', 'bad'], spellbadword('one three four'))
+
+  " With a damaged image the trees are read from the file.
+  let blob = readfile('Xwords.spl', 'B')
+  call writefile(blob[:-10], 'Xwords.spl')
+  set spelllang=
+  set spelllang=Xwords.spl
+  call assert_equal(['three', 'bad'], spellbadword('one three four'))
+
+  set spelllang& spell&
+  call delete('Xwords')
+  call delete('Xwords.spl')
+endfunc
+
+" An image with an index outside of the tree is not used.
+func Test_spell_image_corrupt()
+  call writefile(['one', 'two', 'three'], 'Xwords')
+  mkspell! Xcorrupt.spl Xwords
+  " Use a file that isn't loaded yet, a mapped file must not be changed.
+  let blob = readfile('Xcorrupt.spl', 'B')
+
+  " Find <imagemagic>, it is only used with the same byte order.
+  let magic = 0z6d497053
+  let idx = -1
+  for i in range(len(blob) - 4)
+    if blob[i : i + 3] == magic
+      let idx = i
+      break
+    endif
+  endfor
+  if idx < 0
+    call delete('Xwords')
+    call delete('Xcorrupt.spl')
+    return
+  endif
+
+  " <idxsize> and <imagelen> follow, then the first sibling of the root of
+  " the first tree, make its child index point far outside of the tree.
+  let pos = idx + 12 + 4
+  let blob[pos] = 0xff
+  let blob[pos + 1] = 0xff
+  let blob[pos + 2] = 0xff
+  let blob[pos + 3] = 0x7f
+  call writefile(blob, 'Xcorrupt.spl')
+  set spelllang=Xcorrupt.spl spell
+  call assert_equal(['four', 'bad'], spellbadword('one two three four'))
+  call assert_equal('three', spellsuggest('thre', 1)[0])
+
+  set spelllang& spell&
+  call delete('Xwords')
+  call delete('Xcorrupt.spl')
+endfunc
+
+" :mkspell! replaces the file a symlink points to, keeps its permissions and
+" doesn't overwrite another file.
+func Test_spell_image_write()
+  if !has('unix')
+    return
+  endif
+  call writefile(['one', 'two', 'three'], 'Xwords')
+  mkspell! Xwords.spl Xwords
+  call setfperm('Xwords.spl', 'rw-------')
+  mkspell! Xwords.spl Xwords
+  call assert_equal('rw-------', getfperm('Xwords.spl'))
+
+  silent !ln -s Xwords.spl Xlink.spl
+  call writefile(['keep'], 'Xlink.spl.tmp')
+  call writefile(['keep'], 'Xwords.spl.tmp')
+
+  call writefile(['one', 'two', 'four'], 'Xwords')
+  mkspell! Xlink.spl Xwords
+  call assert_equal('Xwords.spl', resolve('Xlink.spl'))
+  call assert_equal('rw-------', getfperm('Xwords.spl'))
+  call assert_equal(['keep'], readfile('Xlink.spl.tmp'))
+  call assert_equal(['keep'], readfile('Xwords.spl.tmp'))
+  set spelllang=Xlink.spl spell
+  call assert_equal(['three', 'bad'], spellbadword('one three four'))
+
+  set spelllang& spell&
+  call delete('Xwords')
+  call delete('Xwords.spl')
+  call delete('Xlink.spl')
+  call delete('Xlink.spl.tmp')
+  call delete('Xwords.spl.tmp')
+endfunc
+
 func Test_spellfile_value()
   set spellfile=Xdir/Xtest.latin1.add
   set spellfile=Xdir/Xtest.utf-8.add,Xtest_other.add
@@ -407,7 +407,7 @@ func Test_invalid_args()
     call assert_equal('More info with: "vim -h"',                 out[2])
   endfor
 
-  for opt in ['-c', '-i', '-s', '-t', '-T', '-u', '-U', '-w', '-W', '--cmd', '--startuptime']
+  for opt in ['-c', '-i', '-s', '-t', '-T', '-u', '-U', '-w', '-W', '--cmd', '--startuptime', '--startuptrace']
     let out = split(system(GetVimCommand() .. ' '  .. opt), "\n")
     call assert_equal(1, v:shell_error)
     call assert_match('^VIM - Vi IMproved .* (.*)$',             out[0])
@@ -554,6 +554,44 @@ func Test_startuptime()
   call delete('Xtestout')
 endfunc
 
+func Test_startuptrace()
+  if !has('startuptime')
+    return
+  endif
+  let after = ['au User Traced let g:traced = 1', 'doautocmd User Traced',
+        \ 'au User Tr* let g:traced = 2', "exe \"doautocmd User Tr\xe9ced\"",
+        \ 'set shiftwidth=3 fileformat=mac', 'let &tabstop = 5', 'qall']
+  if RunVim([], after, '--startuptrace Xtestout one')
+    let lines = readfile('Xtestout')
+    " a byte that is not valid UTF-8 is escaped
+    call assert_match('"User Tr\\u00e9ced"', join(lines))
+    call assert_notmatch("\xe9", join(lines))
+    let events = json_decode(join(lines, "\n")).traceEvents
+    let names = map(filter(copy(events), 'v:val.ph == "i"'), 'v:val.name')
+    call assert_equal('--- VIM STARTING ---', names[0])
+    call assert_notequal(-1, index(names, 'parsing arguments'))
+
+    let spans = filter(copy(events), 'v:val.ph == "X"')
+    let script = filter(copy(spans), 'v:val.name =~ "Xafter"')
+    call assert_equal(1, len(script))
+    call assert_equal('source', script[0].cat)
+    let autocmd = filter(copy(spans), 'v:val.name == "User Traced"')
+    call assert_equal(1, len(autocmd))
+    call assert_equal('autocmd', autocmd[0].cat)
+    " the autocommand span is nested in the script span
+    call assert_inrange(script[0].ts, script[0].ts + script[0].dur, autocmd[0].ts)
+    call assert_true(script[0].args.self_us <= script[0].dur - autocmd[0].dur)
+    call assert_true(script[0].args.allocs > 0)
+
+    " setting an option is a span, with ":set" and ":let"
+    let options = map(filter(copy(spans), 'v:val.cat == "option"'),
+          \ 'v:val.name')
+    call assert_equal(['shiftwidth', 'fileformat', 'tabstop'],
+          \ filter(options, 'v:val =~ "^\\(shiftwidth\\|fileformat\\|tabstop\\)$"'))
+  endif
+  call delete('Xtestout')
+endfunc
+
 func Test_read_stdin()
   let after =<< trim [CODE]
     write Xtestout
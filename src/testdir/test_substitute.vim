@@ -716,3 +716,39 @@ one two
 
   close!
 endfunc
+
+func Test_sub_many_lines()
+  new
+  call setline(1, map(range(1, 5000), 'v:val % 3 ? "foo " . v:val : "bar"'))
+  let orig = getline(1, '$')
+  let expected = map(copy(orig), 'substitute(v:val, "o", "xyz", "g")')
+  let &undolevels = &undolevels
+  let seq = undotree().seq_last
+
+  " changes lines in many data blocks and grows them
+  %s/o/xyz/g
+  call assert_equal(expected, getline(1, '$'))
+  call assert_equal(seq + 1, undotree().seq_last)
+  call assert_equal(len(join(expected, "\n")) + 2, line2byte(line('$') + 1))
+  call assert_equal(len(join(expected[:2999], "\n")) + 2, line2byte(3001))
+
+  undo
+  call assert_equal(orig, getline(1, '$'))
+  call assert_equal(len(join(orig, "\n")) + 2, line2byte(line('$') + 1))
+  redo
+  call assert_equal(expected, getline(1, '$'))
+
+  " splitting a line in the middle of the changed lines
+  undo
+  %s/^foo [12]0$/a\rb/
+  let &undolevels = &undolevels
+  %s/foo/F/
+  call assert_equal(['F 8', 'bar', 'a', 'b', 'F 11'], getline(8, 12))
+  call assert_equal(['F 19', 'a', 'b', 'bar', 'F 22'], getline(20, 24))
+  call assert_equal(5002, line('$'))
+  undo
+  undo
+  call assert_equal(orig, getline(1, '$'))
+
+  bwipe!
+endfunc
@@ -115,3 +115,102 @@ func Test_tagsfile_without_trailing_newline()
   call delete('Xtags')
   set tags&
 endfunc
+
+func Test_tagindex()
+  call writefile([
+	\ "!_TAG_FILE_SORTED\t0\t/0=unsorted/",
+	\ "zebra\tXzebra.c\t1",
+	\ "FooBar\tXfoo.c\t1",
+	\ "foobar\tXfoo.c\t2",
+	\ "Barfoo\tXbar.c\t1",
+	\ "fooBaz\tXfoo.c\t3",
+	\ "bar\tXbar.c\t2",
+	\ ], 'Xtags')
+  set tags=Xtags ignorecase
+  let expected = {}
+  for pat in ['^foo', 'foobar', 'bar', 'o.*z', 'xyz', '^b']
+    let expected[pat] = map(taglist(pat), {i, v -> v.name})
+  endfor
+  call assert_equal(['foobar', 'fooBaz', 'FooBar'], expected['^foo'])
+
+  set tagindex
+  for pat in keys(expected)
+    call assert_equal(expected[pat], map(taglist(pat), {i, v -> v.name}), pat)
+  endfor
+  set noignorecase
+  call assert_equal(['foobar'], map(taglist('^foob'), {i, v -> v.name}))
+  call assert_equal(['FooBar', 'Barfoo'], map(taglist('Bar'), {i, v -> v.name}))
+
+  " a change in the same second that keeps the size is noticed
+  let lines = readfile('Xtags')
+  call writefile(map(lines, {i, v -> substitute(v, '^zebra', 'xebra', '')}), 'Xtags')
+  call assert_equal(['xebra'], map(taglist('^xeb'), {i, v -> v.name}))
+
+  " the index is updated when the tags file changes
+  call writefile(["fooNew\tXfoo.c\t4"], 'Xtags', 'a')
+  call assert_equal(['foobar', 'fooBaz', 'fooNew'],
+	\ map(taglist('^foo'), {i, v -> v.name}))
+
+  set tags& tagindex&
+  call delete('Xtags')
+endfunc
+
+func Test_tagcache()
+  call writefile([
+	\ "bar\tXbar.c\t1",
+	\ "foo\tXfoo.c\t1",
+	\ "foobar\tXfoo.c\t2",
+	\ ], 'Xtags')
+  set tags=Xtags tagcache=100
+  call assert_equal([], tagcacheinfo())
+  call assert_equal(['foo'], map(taglist('^foo$'), {i, v -> v.name}))
+  let info = tagcacheinfo()
+  call assert_equal(1, len(info))
+  call assert_equal('Xtags', info[0].name)
+  call assert_equal(getfsize('Xtags'), info[0].size)
+  call assert_equal(getfsize('Xtags'), info[0].cached)
+  call assert_equal(0, info[0].index)
+
+  " a change in the same second that keeps the size is noticed
+  call writefile([
+	\ "bar\tXbar.c\t1",
+	\ "fox\tXfoo.c\t1",
+	\ "foobar\tXfoo.c\t2",
+	\ ], 'Xtags')
+  call assert_equal(['fox'], map(taglist('^fo.$'), {i, v -> v.name}))
+  call writefile([
+	\ "bar\tXbar.c\t1",
+	\ "foo\tXfoo.c\t1",
+	\ "foobar\tXfoo.c\t2",
+	\ ], 'Xtags')
+
+  " the cached contents are dropped when the file changes
+  call writefile(["fooNew\tXfoo.c\t3"], 'Xtags', 'a')
+  call assert_equal(['foo', 'foobar', 'fooNew'],
+	\ map(taglist('^foo'), {i, v -> v.name}))
+  call assert_equal(getfsize('Xtags'), tagcacheinfo()[0].cached)
+
+  set tagindex ignorecase
+  call assert_equal(['bar', 'foobar'], map(taglist('bar'), {i, v -> v.name}))
+  call assert_true(tagcacheinfo()[0].index > 0)
+
+  " the cache is emptied when 'tagcache' is zero
+  set tagcache=0 tagindex&
+  call assert_equal(['foo'], map(taglist('^foo$'), {i, v -> v.name}))
+  call assert_equal([], tagcacheinfo())
+
+  set tags& tagcache& ignorecase&
+  call delete('Xtags')
+endfunc
+
+func Test_tagcache_crlf()
+  call writefile(["foo\tXfoo.c\t/^foo$/;\"\tkind:f\r", "bar\tXbar.c\t1\r"], 'Xtags')
+  set tags=Xtags
+  let expected = taglist('.')
+  call assert_equal(2, len(expected))
+  set tagcache=100
+  call assert_equal(expected, taglist('.'))
+  call assert_equal(expected, taglist('.'))
+  set tags& tagcache&
+  call delete('Xtags')
+endfunc
@@ -317,6 +317,27 @@ func Test_terminal_scrollback()
   call delete('Xtext')
 endfunc
 
+func Test_terminal_scrollback_maxmem()
+  let buf = Run_shell_in_terminal({'term_rows': 15})
+  " Each line takes more than 100 bytes, 3000 lines don't fit in 'maxmem'.
+  set termwinscroll=100000 maxmem=100
+  call writefile(map(range(3000), 'v:val . repeat(" x", 30)'), 'Xtext')
+  if has('win32')
+    call term_sendkeys(buf, "type Xtext\<CR>")
+  else
+    call term_sendkeys(buf, "cat Xtext\<CR>")
+  endif
+  let rows = term_getsize(buf)[0]
+  call WaitForAssert({-> assert_match( '^2999 x', term_getline(buf, rows - 1) . term_getline(buf, rows - 2))})
+  call assert_inrange(100, 1000, line('$'))
+
+  call Stop_shell_in_terminal(buf)
+  call term_wait(buf)
+  exe buf . 'bwipe'
+  set termwinscroll& maxmem&
+  call delete('Xtext')
+endfunc
+
 func Test_terminal_postponed_scrollback()
   if !has('unix')
     " tail -f only works on Unix
@@ -2069,3 +2090,23 @@ func Test_terminal_getwinpos()
   set splitright&
   only!
 endfunc
+
+func Test_terminal_update_delay()
+  if !CanRunVimInTerminal() || !has('timers')
+    return
+  endif
+  call assert_equal(20, &termwinupdate)
+  call writefile([
+	\ 'set termwinupdate=10000',
+	\ "call term_start(['/bin/sh', '-c', 'echo one; sleep 0.2; echo two; sleep 3'], {'curwin': 1})",
+	\ ], 'XTest_update_delay')
+  let buf = RunVimInTerminal('-S XTest_update_delay', {'rows': 8})
+
+  " The time is not up, but the output is drawn once the job is idle.
+  call WaitForAssert({-> assert_equal('two', trim(term_getline(buf, 2)))}, 1500)
+
+  call term_sendkeys(buf, "\<C-W>:qa!\<CR>")
+  call WaitForAssert({-> assert_equal("finished", term_getstatus(buf))})
+  only!
+  call delete('XTest_update_delay')
+endfunc
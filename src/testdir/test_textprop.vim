@@ -131,6 +131,51 @@ func Test_prop_add()
   bwipe!
 endfunc
 
+func Test_prop_add_list()
+  new
+  call AddPropTypes()
+  call setline(1, ['one two three', 'four five', 'six'])
+
+  " Same result as using prop_add() for each item.
+  call prop_add_list({'type': 'one'}, [
+	\ {'lnum': 1, 'col': 9, 'length': 5, 'id': 13, 'type': 'three'},
+	\ {'lnum': 1, 'col': 5, 'length': 3, 'id': 12, 'type': 'two'},
+	\ {'lnum': 1, 'col': 1, 'length': 3, 'id': 11},
+	\ {'lnum': 1, 'col': 1, 'length': 13, 'id': 14, 'type': 'whole'},
+	\ {'lnum': 2, 'col': 6, 'end_lnum': 3, 'end_col': 3, 'id': 2},
+	\ ])
+  call assert_equal(Get_expected_props(), prop_list(1))
+  call assert_equal([{'col': 6, 'length': 5, 'id': 2, 'type': 'one', 'start': 1, 'end': 0}], prop_list(2))
+  call assert_equal([{'col': 1, 'length': 2, 'id': 2, 'type': 'one', 'start': 0, 'end': 1}], prop_list(3))
+  call assert_equal(2, prop_remove({'id': 2, 'all': 1}))
+
+  " Nothing is added when one of the items is invalid.
+  call prop_clear(1, 3)
+  call assert_fails("call prop_add_list({}, [{'lnum': 1, 'col': 1, 'type': 'one'}, {'lnum': 9, 'col': 1, 'type': 'one'}])", 'E966:')
+  call assert_fails("call prop_add_list({}, [{'lnum': 1, 'col': 1, 'type': 'one'}, {'lnum': 1, 'col': 1}])", 'E965:')
+  call assert_fails("call prop_add_list({}, [{'lnum': 1, 'col': 0, 'type': 'one'}])", 'E964:')
+  call assert_fails("call prop_add_list({}, [{'lnum': 1, 'col': 1, 'type': 'one'}, {'lnum': 3, 'col': 6, 'type': 'one'}])", 'E964:')
+  call assert_fails("call prop_add_list({}, [{'lnum': 1, 'col': 1, 'type': 'xxx'}])", 'E971:')
+  call assert_fails("call prop_add_list({}, [1])", 'E715:')
+  call assert_fails("call prop_add_list({}, 1)", 'E714:')
+  call assert_equal([], prop_list(1))
+  call assert_equal([], prop_list(3))
+  call prop_add_list({}, [{'lnum': 3, 'col': 5, 'type': 'one'}])
+  call assert_equal([{'col': 5, 'length': 0, 'id': 0, 'type': 'one', 'start': 1, 'end': 1}], prop_list(3))
+  call prop_clear(3)
+
+  " Another buffer.
+  let bufnr = bufnr('')
+  new
+  call prop_add_list({'bufnr': bufnr, 'type': 'two'}, [{'lnum': 2, 'col': 1, 'length': 4}])
+  call assert_equal([], prop_list(1))
+  call assert_equal([{'col': 1, 'length': 4, 'id': 0, 'type': 'two', 'start': 1, 'end': 1}], prop_list(2, {'bufnr': bufnr}))
+  bwipe!
+
+  call DeletePropTypes()
+  bwipe!
+endfunc
+
 func Test_prop_remove()
   new
   call AddPropTypes()
@@ -155,6 +200,70 @@ func Test_prop_remove()
   bwipe!
 endfunc
 
+func Test_prop_remove_after_line_changes()
+  new
+  call AddPropTypes()
+  call setline(1, map(range(1, 100), '"line " . v:val'))
+  for lnum in range(10, 100, 10)
+    call prop_add(lnum, 1, {'length': 4, 'id': lnum, 'type': 'one'})
+  endfor
+  call prop_add(50, 6, {'length': 2, 'type': 'two'})
+
+  " Properties move with inserted and deleted lines.
+  call append(5, ['new 1', 'new 2'])
+  20,21delete
+  call assert_equal(20, prop_list(20)[0].id)
+  call assert_equal(1, prop_remove({'id': 20}))
+  call assert_equal(0, prop_remove({'id': 20}))
+  call assert_equal(1, prop_remove({'type': 'one'}, 26, 30))
+  call assert_equal([], prop_list(30))
+
+  " Split a line with a property and join it again.
+  call cursor(50, 3)
+  exe "normal! i\<CR>\<Esc>"
+  call assert_equal([4], map(filter(prop_list(51), 'v:val.type == "two"'), 'v:val.col'))
+  50join!
+  call assert_equal(1, prop_remove({'type': 'two'}))
+  call assert_equal(0, prop_remove({'type': 'two'}))
+
+  " Deleting and undoing brings the properties back.
+  set ul&
+  1,$delete
+  call assert_equal(1, line('$'))
+  undo
+  call assert_equal(9, prop_remove({'type': 'one', 'all': 1}))
+  call assert_equal(0, prop_remove({'type': 'one', 'all': 1}))
+
+  call DeletePropTypes()
+  bwipe!
+endfunc
+
+func Test_prop_remove_many_ids()
+  new
+  call AddPropTypes()
+  call setline(1, map(range(1, 3000), '"line " . v:val'))
+  for lnum in range(1, 3000)
+    call prop_add(lnum, 1, {'length': 4, 'id': lnum, 'type': 'one'})
+  endfor
+
+  " Deleting lines one by one.
+  g/5$/d
+  call assert_equal(2700, line('$'))
+  call assert_equal(0, prop_remove({'id': 5}))
+  call assert_equal(1, prop_remove({'id': 6}, 5, 5))
+  call assert_equal(1, prop_remove({'id': 3000}, 2700, 2700))
+
+  " Inserting lines before and between the properties.
+  call append(0, map(range(1, 500), '"new " . v:val'))
+  2000,2099g/^/call append(line('.'), 'added')
+  call assert_equal(3300, line('$'))
+  call assert_equal(1, prop_remove({'id': 2999}, 3299, 3299))
+  call assert_equal(2697, prop_remove({'type': 'one', 'all': 1}))
+
+  call DeletePropTypes()
+  bwipe!
+endfunc
+
 func SetupOneLine()
   call setline(1, 'xonex xtwoxx')
   normal gg0
@@ -451,3 +451,39 @@ funct Test_undofile()
 
   set undodir&
 endfunc
+
+func Test_undomaxmem()
+  new
+  set undomaxmem=1
+  call setline(1, map(range(1, 200), 'repeat("x", 50) . v:val'))
+  set ul=100
+  let orig = getline(1, '$')
+  for i in range(1, 20)
+    exe '%s/^.\{' . (i - 1) . '}\zsx/' . (i % 10) . '/'
+    set ul=100
+  endfor
+  let changed = getline(1, '$')
+  call assert_equal('12345678901234567890' . repeat('x', 30) . '1', changed[0])
+
+  " Text of older changes was moved out of memory, undo must get it back.
+  undo 1
+  call assert_equal(orig, getline(1, '$'))
+  undo 21
+  call assert_equal(changed, getline(1, '$'))
+  earlier 10
+  call assert_equal('1234567890' . repeat('x', 40) . '1', getline(1))
+
+  if has('persistent_undo')
+    wundo! Xundomaxmem
+    later 10
+    set undomaxmem&
+    rundo Xundomaxmem
+    call assert_equal(21, undotree().seq_last)
+    undo 1
+    call assert_equal(orig, getline(1, '$'))
+    call delete('Xundomaxmem')
+  endif
+
+  set undomaxmem& ul&
+  bwipe!
+endfunc
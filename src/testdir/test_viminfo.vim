@@ -532,3 +532,68 @@ func Test_viminfo_oldfiles()
   call assert_equal(['1: /tmp/file_one.txt', '2: /tmp/file_two.txt'], filter(split(execute('filter file_ oldfiles'), "\n"), {i, v -> v =~ '/tmp/'}))
   call assert_equal(['3: /tmp/another.txt'], filter(split(execute('filter /another/ oldfiles'), "\n"), {i, v -> v =~ '/tmp/'}))
 endfunc
+
+func Test_viminfo_marks_index()
+  let save_viminfofile = &viminfofile
+  call writefile(['a', 'b', 'c', 'd', 'e'], 'Xmarkone')
+  call writefile(['a', 'b', 'c', 'd', 'e'], 'Xmarktwo')
+  let lines = [
+	\ '*encoding=utf-8',
+	\ '',
+	\ '> ' . fnamemodify('Xmarkone', ':p:~'),
+	\ "\ta\t2\t0",
+	\ '',
+	\ '> ' . fnamemodify('Xmarktwo', ':p:~'),
+	\ "\ta\t3\t0",
+	\ ]
+  call writefile(lines, 'Xviminfo')
+  set viminfofile=Xviminfo
+  edit Xmarkone
+  call assert_equal(2, line("'a"))
+
+  " When the viminfo file changes the marks are found in the new file, also
+  " when the size doesn't change.
+  call writefile(lines[:1] + lines[5:6] + [''] + lines[2:3], 'Xviminfo')
+  edit Xmarktwo
+  call assert_equal(3, line("'a"))
+  edit Xnotexisting
+  call assert_equal(0, line("'a"))
+
+  let &viminfofile = save_viminfofile
+  bwipe! Xmarkone Xmarktwo Xnotexisting
+  call delete('Xviminfo')
+  call delete('Xmarkone')
+  call delete('Xmarktwo')
+endfunc
+
+func Test_viminfo_history_duplicates()
+  call histdel(':')
+  call test_settime(10)
+  call histadd(':', 'echo "typed"')
+  let lines = [
+	\ '# Viminfo version',
+	\ '|1,4',
+	\ '',
+	\ '*encoding=utf-8',
+	\ '',
+	\ '# Command Line History (newest to oldest):',
+	\ ':echo "typed"',
+	\ '|2,0,5,,"echo \"typed\""',
+	\ ':echo "one"',
+	\ '|2,0,3,,"echo \"one\""',
+	\ ':echo "two"',
+	\ '|2,0,2,,"echo \"two\""',
+	\ ':echo "one"',
+	\ '|2,0,1,,"echo \"one\""',
+	\ ]
+  call writefile(lines, 'Xviminfo')
+  rviminfo Xviminfo
+  call histadd(':', 'echo "three"')
+  wviminfo Xviminfo
+  call assert_equal([':echo "three"', ':echo "typed"', ':echo "one"',
+	\ ':echo "two"'], filter(readfile('Xviminfo'), 'v:val =~ "^:"'))
+
+  call histdel(':')
+  call test_settime(0)
+  call delete('Xviminfo')
+endfunc
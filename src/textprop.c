@@ -162,6 +162,58 @@ f_prop_add(typval_T *argvars, typval_T *rettv UNUSED)
 							  curbuf, &argvars[2]);
 }
 
+/*
+ * Get the end of a text property from "end_lnum", "end_col" and "length" in
+ * "dict", for a property starting at "start_lnum" and "start_col".
+ * Gives an error message and returns FAIL when invalid.
+ */
+    static int
+get_prop_end(
+	dict_T	    *dict,
+	linenr_T    start_lnum,
+	colnr_T	    start_col,
+	linenr_T    *end_lnum,
+	colnr_T	    *end_col)
+{
+    if (dict_find(dict, (char_u *)"end_lnum", -1) != NULL)
+    {
+	*end_lnum = dict_get_number(dict, (char_u *)"end_lnum");
+	if (*end_lnum < start_lnum)
+	{
+	    semsg(_(e_invargval), "end_lnum");
+	    return FAIL;
+	}
+    }
+    else
+	*end_lnum = start_lnum;
+
+    if (dict_find(dict, (char_u *)"length", -1) != NULL)
+    {
+	long length = dict_get_number(dict, (char_u *)"length");
+
+	if (length < 0 || *end_lnum > start_lnum)
+	{
+	    semsg(_(e_invargval), "length");
+	    return FAIL;
+	}
+	*end_col = start_col + length;
+    }
+    else if (dict_find(dict, (char_u *)"end_col", -1) != NULL)
+    {
+	*end_col = dict_get_number(dict, (char_u *)"end_col");
+	if (*end_col <= 0)
+	{
+	    semsg(_(e_invargval), "end_col");
+	    return FAIL;
+	}
+    }
+    else if (start_lnum == *end_lnum)
+	*end_col = start_col;
+    else
+	*end_col = 1;
+    return OK;
+}
+
 /*
  * Shared between prop_add() and popup_create().
  * "dict_arg" is the function argument of a dict containing "bufnr".
@@ -197,42 +249,8 @@ prop_add_common(
     }
     type_name = dict_get_string(dict, (char_u *)"type", FALSE);
 
-    if (dict_find(dict, (char_u *)"end_lnum", -1) != NULL)
-    {
-	end_lnum = dict_get_number(dict, (char_u *)"end_lnum");
-	if (end_lnum < start_lnum)
-	{
-	    semsg(_(e_invargval), "end_lnum");
-	    return;
-	}
-    }
-    else
-	end_lnum = start_lnum;
-
-    if (dict_find(dict, (char_u *)"length", -1) != NULL)
-    {
-	long length = dict_get_number(dict, (char_u *)"length");
-
-	if (length < 0 || end_lnum > start_lnum)
-	{
-	    semsg(_(e_invargval), "length");
-	    return;
-	}
-	end_col = start_col + length;
-    }
-    else if (dict_find(dict, (char_u *)"end_col", -1) != NULL)
-    {
-	end_col = dict_get_number(dict, (char_u *)"end_col");
-	if (end_col <= 0)
-	{
-	    semsg(_(e_invargval), "end_col");
-	    return;
-	}
-    }
-    else if (start_lnum == end_lnum)
-	end_col = start_col;
-    else
-	end_col = 1;
+    if (get_prop_end(dict, start_lnum, start_col, &end_lnum, &end_col) == FAIL)
+	return;
 
     if (dict_find(dict, (char_u *)"id", -1) != NULL)
 	id = dict_get_number(dict, (char_u *)"id");
@@ -326,12 +344,254 @@ prop_add_common(
 	buf->b_ml.ml_line_ptr = newtext;
 	buf->b_ml.ml_line_len += sizeof(textprop_T);
 	buf->b_ml.ml_flags |= ML_LINE_DIRTY;
+
+	prop_index_add_line(buf, lnum, newprops + i * sizeof(textprop_T), 1);
     }
 
     buf->b_has_textprop = TRUE;  // this is never reset
     redraw_buf_later(buf, NOT_VALID);
 }
 
+/*
+ * One text property in one line, used by prop_add_list().
+ */
+typedef struct
+{
+    linenr_T	pa_lnum;	// line to add the property to
+    int		pa_seq;		// order in which the properties were given
+    colnr_T	pa_col;		// start column
+    colnr_T	pa_end_col;	// end column, zero for the end of the line
+    textprop_T	pa_prop;	// tp_id, tp_type and tp_flags are set
+} propadd_T;
+
+/*
+ * Sort function for propadd_T: on line number, then on the order given.
+ */
+    static int
+propadd_compare(const void *s1, const void *s2)
+{
+    propadd_T *p1 = (propadd_T *)s1;
+    propadd_T *p2 = (propadd_T *)s2;
+
+    if (p1->pa_lnum != p2->pa_lnum)
+	return p1->pa_lnum < p2->pa_lnum ? -1 : 1;
+    return p1->pa_seq - p2->pa_seq;
+}
+
+/*
+ * Add the "count" text properties in "pa" to line "lnum" of "buf".
+ * The line is rewritten only once.  The columns must have been checked.
+ * Returns FAIL when out of memory.
+ */
+    static int
+prop_add_to_line(buf_T *buf, linenr_T lnum, propadd_T *pa, int count)
+{
+    int		proplen;
+    char_u	*props = NULL;
+    size_t	textlen;
+    char_u	*newtext;
+    char_u	*newprops;
+    textprop_T	tmp_prop;
+    int		n;
+    int		i;
+    int		total;
+
+    proplen = get_text_props(buf, lnum, &props, TRUE);
+    textlen = buf->b_ml.ml_line_len - proplen * sizeof(textprop_T);
+
+    newtext = alloc(buf->b_ml.ml_line_len + count * sizeof(textprop_T));
+    if (newtext == NULL)
+	return FAIL;
+    mch_memmove(newtext, buf->b_ml.ml_line_ptr, textlen);
+    newprops = newtext + textlen;
+    if (proplen > 0)
+	mch_memmove(newprops, props, proplen * sizeof(textprop_T));
+    total = proplen;
+
+    for (n = 0; n < count; ++n)
+    {
+	colnr_T col = pa[n].pa_col;
+	long	length;
+
+	if (pa[n].pa_end_col == 0)
+	    length = (int)textlen - col + 1;
+	else
+	    length = pa[n].pa_end_col - col;
+	if (length > (long)textlen)
+	    length = (int)textlen;	// can include the end-of-line
+	if (length < 0)
+	    length = 0;		// zero-width property
+
+	// Insert before the first property at or after this column, like
+	// prop_add() does.
+	for (i = 0; i < total; ++i)
+	{
+	    mch_memmove(&tmp_prop, newprops + i * sizeof(textprop_T),
+							   sizeof(textprop_T));
+	    if (tmp_prop.tp_col >= col)
+		break;
+	}
+	if (i < total)
+	    mch_memmove(newprops + (i + 1) * sizeof(textprop_T),
+				    newprops + i * sizeof(textprop_T),
+				    sizeof(textprop_T) * (total - i));
+	tmp_prop = pa[n].pa_prop;
+	tmp_prop.tp_col = col;
+	tmp_prop.tp_len = length;
+	mch_memmove(newprops + i * sizeof(textprop_T), &tmp_prop,
+							   sizeof(textprop_T));
+	++total;
+    }
+
+    if (buf->b_ml.ml_flags & ML_LINE_DIRTY)
+	vim_free(buf->b_ml.ml_line_ptr);
+    buf->b_ml.ml_line_ptr = newtext;
+    buf->b_ml.ml_line_len += count * sizeof(textprop_T);
+    buf->b_ml.ml_flags |= ML_LINE_DIRTY;
+
+    prop_index_add_line(buf, lnum, newprops, total);
+    return OK;
+}
+
+/*
+ * prop_add_list({props}, {items})
+ */
+    void
+f_prop_add_list(typval_T *argvars, typval_T *rettv UNUSED)
+{
+    dict_T	*dict;
+    buf_T	*buf = curbuf;
+    char_u	*default_type = NULL;
+    int		default_id = 0;
+    listitem_T	*li;
+    garray_T	ga;
+    propadd_T	*pa;
+    int		seq = 0;
+    int		i;
+    int		n;
+
+    if (argvars[0].v_type != VAR_DICT)
+    {
+	emsg(_(e_dictreq));
+	return;
+    }
+    if (argvars[1].v_type != VAR_LIST)
+    {
+	emsg(_(e_listreq));
+	return;
+    }
+    dict = argvars[0].vval.v_dict;
+    if (get_bufnr_from_arg(&argvars[0], &buf) == FAIL)
+	return;
+    if (dict != NULL)
+    {
+	if (dict_find(dict, (char_u *)"type", -1) != NULL)
+	    default_type = dict_get_string(dict, (char_u *)"type", FALSE);
+	if (dict_find(dict, (char_u *)"id", -1) != NULL)
+	    default_id = dict_get_number(dict, (char_u *)"id");
+    }
+    if (argvars[1].vval.v_list == NULL)
+	return;
+
+    if (buf->b_ml.ml_mfp == NULL)
+	ml_open(buf);
+
+    // First check all the items and split them into one entry per line.
+    ga_init2(&ga, sizeof(propadd_T), 100);
+    for (li = argvars[1].vval.v_list->lv_first; li != NULL; li = li->li_next)
+    {
+	dict_T	    *d;
+	char_u	    *type_name = default_type;
+	proptype_T  *type;
+	linenr_T    start_lnum;
+	colnr_T	    start_col;
+	linenr_T    end_lnum;
+	colnr_T	    end_col;
+	linenr_T    lnum;
+
+	if (li->li_tv.v_type != VAR_DICT || li->li_tv.vval.v_dict == NULL)
+	{
+	    emsg(_(e_dictreq));
+	    goto theend;
+	}
+	d = li->li_tv.vval.v_dict;
+	if (dict_find(d, (char_u *)"type", -1) != NULL)
+	    type_name = dict_get_string(d, (char_u *)"type", FALSE);
+	if (type_name == NULL)
+	{
+	    emsg(_("E965: missing property type name"));
+	    goto theend;
+	}
+	type = lookup_prop_type(type_name, buf);
+	if (type == NULL)
+	    goto theend;
+
+	start_lnum = dict_get_number(d, (char_u *)"lnum");
+	start_col = dict_get_number(d, (char_u *)"col");
+	if (start_col < 1)
+	{
+	    semsg(_(e_invalid_col), (long)start_col);
+	    goto theend;
+	}
+	if (get_prop_end(d, start_lnum, start_col, &end_lnum, &end_col)
+									== FAIL)
+	    goto theend;
+	if (start_lnum < 1 || start_lnum > buf->b_ml.ml_line_count)
+	{
+	    semsg(_(e_invalid_lnum), (long)start_lnum);
+	    goto theend;
+	}
+	if (end_lnum > buf->b_ml.ml_line_count)
+	{
+	    semsg(_(e_invalid_lnum), (long)end_lnum);
+	    goto theend;
+	}
+	if (start_col - 1
+		  > (colnr_T)STRLEN(ml_get_buf(buf, start_lnum, FALSE)) + 1)
+	{
+	    semsg(_(e_invalid_col), (long)start_col);
+	    goto theend;
+	}
+
+	if (ga_grow(&ga, end_lnum - start_lnum + 1) == FAIL)
+	    goto theend;
+	for (lnum = start_lnum; lnum <= end_lnum; ++lnum)
+	{
+	    pa = (propadd_T *)ga.ga_data + ga.ga_len++;
+	    pa->pa_lnum = lnum;
+	    pa->pa_seq = seq++;
+	    pa->pa_col = lnum == start_lnum ? start_col : 1;
+	    pa->pa_end_col = lnum == end_lnum ? end_col : 0;
+	    vim_memset(&pa->pa_prop, 0, sizeof(textprop_T));
+	    pa->pa_prop.tp_id = dict_find(d, (char_u *)"id", -1) != NULL
+			    ? dict_get_number(d, (char_u *)"id") : default_id;
+	    pa->pa_prop.tp_type = type->pt_id;
+	    pa->pa_prop.tp_flags = (lnum > start_lnum ? TP_FLAG_CONT_PREV : 0)
+				 | (lnum < end_lnum ? TP_FLAG_CONT_NEXT : 0);
+	}
+    }
+    if (ga.ga_len == 0)
+	goto theend;
+
+    // Then rewrite each line only once.
+    pa = (propadd_T *)ga.ga_data;
+    qsort(pa, (size_t)ga.ga_len, sizeof(propadd_T), propadd_compare);
+    for (i = 0; i < ga.ga_len; i += n)
+    {
+	for (n = 1; i + n < ga.ga_len && pa[i + n].pa_lnum == pa[i].pa_lnum;
+									   ++n)
+	    ;
+	if (prop_add_to_line(buf, pa[i].pa_lnum, pa + i, n) == FAIL)
+	    break;
+    }
+
+    buf->b_has_textprop = TRUE;  // this is never reset
+    redraw_buf_later(buf, NOT_VALID);
+
+theend:
+    ga_clear(&ga);
+}
+
 /*
  * Fetch the text properties for line "lnum" in buffer "buf".
  * Returns the number of text properties and, when non-zero, a pointer to the
@@ -390,6 +650,423 @@ set_text_props(linenr_T lnum, char_u *props, int len)
     curbuf->b_ml.ml_line_ptr = newtext;
     curbuf->b_ml.ml_line_len = textlen + len;
     curbuf->b_ml.ml_flags |= ML_LINE_DIRTY;
+    if (len > 0)
+	prop_index_add_line(curbuf, lnum, props, len / sizeof(textprop_T));
+}
+
+/*
+ * Return the index in the sorted line list "gap" of the first line number
+ * that is not smaller than "lnum".
+ */
+    static int
+prop_index_find_lnum(garray_T *gap, linenr_T lnum)
+{
+    int	low = 0;
+    int	high = gap->ga_len;
+    int	mid;
+
+    while (low < high)
+    {
+	mid = (low + high) / 2;
+	if (((linenr_T *)gap->ga_data)[mid] < lnum)
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+    return low;
+}
+
+/*
+ * Adjust the sorted line list "gap" for inserted or deleted lines.  When
+ * "added" is positive that many lines were inserted below line "lnum".  When
+ * "added" is negative lines "lnum" and following were deleted.
+ */
+    static void
+prop_index_shift_lines(garray_T *gap, linenr_T lnum, long added)
+{
+    linenr_T	*lines = (linenr_T *)gap->ga_data;
+    int		i;
+    int		del;
+
+    if (added > 0)
+	i = prop_index_find_lnum(gap, lnum + 1);
+    else
+    {
+	// drop the deleted lines
+	i = prop_index_find_lnum(gap, lnum);
+	del = prop_index_find_lnum(gap, lnum - added) - i;
+	if (del > 0)
+	{
+	    gap->ga_len -= del;
+	    if (i < gap->ga_len)
+		mch_memmove(lines + i, lines + i + del,
+					 sizeof(linenr_T) * (gap->ga_len - i));
+	}
+    }
+    for ( ; i < gap->ga_len; ++i)
+	lines[i] += added;
+}
+
+/*
+ * Apply the line shifts that were recorded since index entry "pi" was last
+ * used.
+ */
+    static void
+prop_index_catch_up(buf_T *buf, propindex_T *pi)
+{
+    garray_T	*gap = &buf->b_prop_shifts;
+    propshift_T	*ps;
+
+    for ( ; pi->pi_shift < buf->b_prop_shift_first + gap->ga_len;
+								++pi->pi_shift)
+    {
+	ps = (propshift_T *)gap->ga_data
+				      + (pi->pi_shift - buf->b_prop_shift_first);
+	prop_index_shift_lines(&pi->pi_lines, ps->ps_lnum, ps->ps_added);
+    }
+    // The last shift can no longer be extended.
+    buf->b_prop_shift_used = TRUE;
+}
+
+/*
+ * Find the index entry for property type "type_id" or, when "type_id" is
+ * zero, for property ID "id".  When "create" is TRUE add a missing entry.
+ * The line numbers of the entry are made up-to-date.
+ * Returns NULL when not found or out of memory.
+ */
+    static propindex_T *
+prop_index_get(buf_T *buf, int type_id, int id, int create)
+{
+    garray_T	*gap = &buf->b_prop_index;
+    propindex_T	*pi;
+    int		low = 0;
+    int		high = gap->ga_len;
+    int		mid;
+
+    if (type_id != 0)
+	id = 0;
+    // binary search on (pi_type, pi_id)
+    while (low < high)
+    {
+	mid = (low + high) / 2;
+	pi = (propindex_T *)gap->ga_data + mid;
+	if (pi->pi_type < type_id || (pi->pi_type == type_id && pi->pi_id < id))
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+    pi = (propindex_T *)gap->ga_data + low;
+    if (low < gap->ga_len && pi->pi_type == type_id && pi->pi_id == id)
+    {
+	prop_index_catch_up(buf, pi);
+	return pi;
+    }
+    if (!create)
+	return NULL;
+
+    if (gap->ga_itemsize == 0)
+	ga_init2(gap, sizeof(propindex_T), 10);
+    if (ga_grow(gap, 1) == FAIL)
+	return NULL;
+    pi = (propindex_T *)gap->ga_data + low;
+    if (low < gap->ga_len)
+	mch_memmove(pi + 1, pi, sizeof(propindex_T) * (gap->ga_len - low));
+    ++gap->ga_len;
+    pi->pi_type = type_id;
+    pi->pi_id = id;
+    ga_init2(&pi->pi_lines, sizeof(linenr_T), 100);
+    pi->pi_shift = buf->b_prop_shift_first + buf->b_prop_shifts.ga_len;
+    buf->b_prop_shift_used = TRUE;
+    return pi;
+}
+
+/*
+ * Add line "lnum" to the index entry "pi", unless it is already there.
+ */
+    static void
+prop_index_add_lnum(propindex_T *pi, linenr_T lnum)
+{
+    garray_T	*gap = &pi->pi_lines;
+    int		i = prop_index_find_lnum(gap, lnum);
+    linenr_T	*lp;
+
+    lp = (linenr_T *)gap->ga_data + i;
+    if (i < gap->ga_len && *lp == lnum)
+	return;
+    if (ga_grow(gap, 1) == FAIL)
+	return;
+    lp = (linenr_T *)gap->ga_data + i;
+    if (i < gap->ga_len)
+	mch_memmove(lp + 1, lp, sizeof(linenr_T) * (gap->ga_len - i));
+    *lp = lnum;
+    ++gap->ga_len;
+}
+
+/*
+ * Remove index entry "pi" from buffer "buf" when it no longer has lines.
+ */
+    static void
+prop_index_drop_if_empty(buf_T *buf, propindex_T *pi)
+{
+    garray_T	*gap = &buf->b_prop_index;
+    int		idx = (int)(pi - (propindex_T *)gap->ga_data);
+
+    if (pi->pi_lines.ga_len > 0)
+	return;
+    ga_clear(&pi->pi_lines);
+    --gap->ga_len;
+    if (idx < gap->ga_len)
+	mch_memmove(pi, pi + 1, sizeof(propindex_T) * (gap->ga_len - idx));
+}
+
+/*
+ * Add line "lnum" to the index for each of the "count" text properties in
+ * "props".
+ */
+    void
+prop_index_add_line(buf_T *buf, linenr_T lnum, char_u *props, int count)
+{
+    textprop_T	prop;
+    propindex_T	*pi;
+    int		i;
+
+    if (buf->b_prop_index_stale)
+	return;  // it is built again when used
+    for (i = 0; i < count; ++i)
+    {
+	mch_memmove(&prop, props + i * sizeof(textprop_T), sizeof(textprop_T));
+	pi = prop_index_get(buf, prop.tp_type, 0, TRUE);
+	if (pi != NULL)
+	    prop_index_add_lnum(pi, lnum);
+	pi = prop_index_get(buf, 0, prop.tp_id, TRUE);
+	if (pi != NULL)
+	    prop_index_add_lnum(pi, lnum);
+    }
+}
+
+/*
+ * Remove line "lnum" from the index for property type "type_id" or, when
+ * "type_id" is zero, property ID "id".
+ */
+    static void
+prop_index_remove_line(buf_T *buf, linenr_T lnum, int type_id, int id)
+{
+    propindex_T	*pi = prop_index_get(buf, type_id, id, FALSE);
+    garray_T	*gap;
+    linenr_T	*lp;
+    int		i;
+
+    if (pi == NULL)
+	return;
+    gap = &pi->pi_lines;
+    i = prop_index_find_lnum(gap, lnum);
+    lp = (linenr_T *)gap->ga_data + i;
+    if (i < gap->ga_len && *lp == lnum)
+    {
+	--gap->ga_len;
+	if (i < gap->ga_len)
+	    mch_memmove(lp, lp + 1, sizeof(linenr_T) * (gap->ga_len - i));
+	prop_index_drop_if_empty(buf, pi);
+    }
+}
+
+/*
+ * Remove the line shifts that all index entries of buffer "buf" have
+ * applied.
+ */
+    static void
+prop_index_trim(buf_T *buf)
+{
+    garray_T	*gap = &buf->b_prop_shifts;
+    propindex_T	*pi;
+    long	min = buf->b_prop_shift_first + gap->ga_len;
+    int		drop;
+    int		idx;
+
+    for (idx = buf->b_prop_index.ga_len - 1; idx >= 0; --idx)
+    {
+	pi = (propindex_T *)buf->b_prop_index.ga_data + idx;
+	if (pi->pi_shift == buf->b_prop_shift_first + gap->ga_len
+						    && pi->pi_lines.ga_len == 0)
+	    prop_index_drop_if_empty(buf, pi);
+	else if (pi->pi_shift < min)
+	    min = pi->pi_shift;
+    }
+    drop = (int)(min - buf->b_prop_shift_first);
+    if (drop > 0)
+    {
+	gap->ga_len -= drop;
+	mch_memmove(gap->ga_data, (propshift_T *)gap->ga_data + drop,
+					   sizeof(propshift_T) * gap->ga_len);
+	buf->b_prop_shift_first = min;
+    }
+}
+
+/*
+ * Adjust the text property index of buffer "buf" for inserted or deleted
+ * lines.  When "added" is positive that many lines were inserted below line
+ * "lnum".  When "added" is negative lines "lnum" and following were deleted.
+ * The shift is only recorded, index entries apply it when they are used.
+ * Consecutive changes, such as deleting or inserting many lines, are
+ * combined into one shift.
+ */
+    void
+prop_index_adjust(buf_T *buf, linenr_T lnum, long added)
+{
+    garray_T	*gap = &buf->b_prop_shifts;
+    propshift_T	*ps;
+    long	limit;
+
+    if (buf->b_prop_index.ga_len == 0 || buf->b_prop_index_stale)
+	return;
+
+    if (gap->ga_len > 0 && !buf->b_prop_shift_used)
+    {
+	ps = (propshift_T *)gap->ga_data + gap->ga_len - 1;
+	if (added > 0 && ps->ps_added > 0 && lnum >= ps->ps_lnum
+					   && lnum <= ps->ps_lnum + ps->ps_added)
+	{
+	    // inserting lines in or just below inserted lines
+	    ps->ps_added += added;
+	    return;
+	}
+	if (added < 0 && ps->ps_added < 0
+			 && (lnum == ps->ps_lnum || lnum - added == ps->ps_lnum))
+	{
+	    // deleting lines just below or above deleted lines
+	    ps->ps_lnum = lnum;
+	    ps->ps_added += added;
+	    return;
+	}
+    }
+
+    // When all entries applying the shifts would take longer than going
+    // over the buffer text, build the index again when it is used.
+    limit = MAX(100, buf->b_ml.ml_line_count / buf->b_prop_index.ga_len);
+    if (gap->ga_len >= limit)
+    {
+	prop_index_trim(buf);
+	if (gap->ga_len >= limit / 2)
+	    gap = NULL;
+    }
+    if (gap != NULL && gap->ga_itemsize == 0)
+	ga_init2(gap, sizeof(propshift_T), 50);
+    if (gap == NULL || ga_grow(gap, 1) == FAIL)
+    {
+	prop_index_clear(buf);
+	buf->b_prop_index_stale = TRUE;
+	return;
+    }
+    ps = (propshift_T *)gap->ga_data + gap->ga_len++;
+    ps->ps_lnum = lnum;
+    ps->ps_added = added;
+    buf->b_prop_shift_used = FALSE;
+}
+
+/*
+ * Build the text property index of buffer "buf" from the text properties in
+ * its lines.
+ */
+    static void
+prop_index_build(buf_T *buf)
+{
+    linenr_T	lnum;
+    char_u	*text;
+    size_t	textlen;
+
+    prop_index_clear(buf);
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+    {
+	text = ml_get_buf(buf, lnum, FALSE);
+	textlen = STRLEN(text) + 1;
+	if ((size_t)buf->b_ml.ml_line_len > textlen)
+	    prop_index_add_line(buf, lnum, text + textlen,
+		  (int)((buf->b_ml.ml_line_len - textlen) / sizeof(textprop_T)));
+    }
+}
+
+/*
+ * Store the lines between "start" and "end" that may have a text property
+ * with type "type_id" or ID "id" in "lines".  The result is sorted.
+ */
+    static void
+prop_index_find_lines(
+	buf_T	    *buf,
+	int	    type_id,
+	int	    id,
+	linenr_T    start,
+	linenr_T    end,
+	garray_T    *lines)
+{
+    propindex_T	*pi_type = NULL;
+    propindex_T	*pi_id;
+    garray_T	*gap_type = NULL;
+    garray_T	*gap_id = NULL;
+    int		ti = 0;
+    int		ii = 0;
+    linenr_T	lnum;
+
+    if (buf->b_prop_index_stale)
+	prop_index_build(buf);
+    if (type_id > 0)
+	pi_type = prop_index_get(buf, type_id, 0, FALSE);
+    pi_id = prop_index_get(buf, 0, id, FALSE);
+    if (pi_type != NULL)
+    {
+	gap_type = &pi_type->pi_lines;
+	ti = prop_index_find_lnum(gap_type, start);
+    }
+    if (pi_id != NULL)
+    {
+	gap_id = &pi_id->pi_lines;
+	ii = prop_index_find_lnum(gap_id, start);
+    }
+
+    // merge the two sorted lists
+    for (;;)
+    {
+	int use_type = gap_type != NULL && ti < gap_type->ga_len;
+	int use_id = gap_id != NULL && ii < gap_id->ga_len;
+
+	if (use_type && use_id)
+	{
+	    linenr_T lt = ((linenr_T *)gap_type->ga_data)[ti];
+	    linenr_T li = ((linenr_T *)gap_id->ga_data)[ii];
+
+	    lnum = lt < li ? lt : li;
+	    if (lt == lnum)
+		++ti;
+	    if (li == lnum)
+		++ii;
+	}
+	else if (use_type)
+	    lnum = ((linenr_T *)gap_type->ga_data)[ti++];
+	else if (use_id)
+	    lnum = ((linenr_T *)gap_id->ga_data)[ii++];
+	else
+	    break;
+	if (lnum > end || ga_grow(lines, 1) == FAIL)
+	    break;
+	((linenr_T *)lines->ga_data)[lines->ga_len++] = lnum;
+    }
+}
+
+/*
+ * Free the text property index of buffer "buf".
+ */
+    void
+prop_index_clear(buf_T *buf)
+{
+    garray_T	*gap = &buf->b_prop_index;
+    int		i;
+
+    for (i = 0; i < gap->ga_len; ++i)
+	ga_clear(&((propindex_T *)gap->ga_data)[i].pi_lines);
+    ga_clear(gap);
+    ga_clear(&buf->b_prop_shifts);
+    buf->b_prop_shift_first = 0;
+    buf->b_prop_shift_used = FALSE;
+    buf->b_prop_index_stale = FALSE;
 }
 
     static proptype_T *
@@ -554,6 +1231,8 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
     int		do_all = FALSE;
     int		id = -1;
     int		type_id = -1;
+    garray_T	lines;
+    int		li;
 
     rettv->vval.v_number = 0;
     if (argvars[0].v_type != VAR_DICT || argvars[0].vval.v_dict == NULL)
@@ -604,11 +1283,17 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 
     if (end == 0)
 	end = buf->b_ml.ml_line_count;
-    for (lnum = start; lnum <= end; ++lnum)
+
+    // Only visit the lines that the index says may have the property.
+    ga_init2(&lines, sizeof(linenr_T), 100);
+    prop_index_find_lines(buf, type_id, id, start, end, &lines);
+    for (li = 0; li < lines.ga_len; ++li)
     {
-	char_u *text;
-	size_t len;
+	char_u	*text;
+	size_t	len;
+	int	found = FALSE;
 
+	lnum = ((linenr_T *)lines.ga_data)[li];
 	if (lnum > buf->b_ml.ml_line_count)
 	    break;
 	text = ml_get_buf(buf, lnum, FALSE);
@@ -634,7 +1319,10 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 
 			// need to allocate the line to be able to change it
 			if (newptr == NULL)
+			{
+			    ga_clear(&lines);
 			    return;
+			}
 			mch_memmove(newptr, buf->b_ml.ml_line_ptr,
 							buf->b_ml.ml_line_len);
 			buf->b_ml.ml_line_ptr = newptr;
@@ -654,11 +1342,22 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 
 		    ++rettv->vval.v_number;
 		    if (!do_all)
+		    {
+			found = TRUE;  // there may be more
 			break;
+		    }
 		}
 	    }
 	}
+	if (!found)
+	{
+	    // The line has no matching property now, drop it from the index.
+	    if (type_id > 0)
+		prop_index_remove_line(buf, lnum, type_id, 0);
+	    prop_index_remove_line(buf, lnum, 0, id);
+	}
     }
+    ga_clear(&lines);
     redraw_buf_later(buf, NOT_VALID);
 }
 
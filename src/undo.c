@@ -103,6 +103,7 @@ typedef struct {
 static void u_unch_branch(u_header_T *uhp);
 static u_entry_T *u_get_headentry(void);
 static void u_getbot(void);
+static int u_extend_entry(linenr_T top, linenr_T bot);
 static void u_doit(int count);
 static void u_undoredo(int undo);
 static void u_undo_end(int did_undo, int absolute);
@@ -111,6 +112,12 @@ static void u_freeheader(buf_T *buf, u_header_T *uhp, u_header_T **uhpp);
 static void u_freebranch(buf_T *buf, u_header_T *uhp, u_header_T **uhpp);
 static void u_freeentries(buf_T *buf, u_header_T *uhp, u_header_T **uhpp);
 static void u_freeentry(u_entry_T *, long);
+static long_u u_entry_memsize(u_entry_T *uep);
+static void u_spill(buf_T *buf);
+static void u_spill_branch(buf_T *buf, u_header_T *uhp);
+static int u_spill_entry(buf_T *buf, u_entry_T *uep);
+static int u_load_spilled(buf_T *buf, u_header_T *uhp);
+static void u_spill_close(buf_T *buf);
 #ifdef FEAT_PERSISTENT_UNDO
 # ifdef FEAT_CRYPT
 static int undo_flush(bufinfo_T *bi);
@@ -126,6 +133,9 @@ static void unserialize_visualinfo(bufinfo_T *bi, visualinfo_T *info);
 
 #define U_ALLOC_LINE(size) lalloc(size, FALSE)
 
+/* Max number of unchanged lines u_extend_entry() saves to skip a gap. */
+#define U_EXTEND_GAP 2
+
 /* used in undo_end() to report number of added and deleted lines */
 static long	u_newcount, u_oldcount;
 
@@ -515,6 +525,13 @@ u_savecommon(
 #endif
 	}
 
+	/*
+	 * move the text of old changes out of memory when using more than
+	 * 'undomaxmem'
+	 */
+	if (p_umm > 0 && curbuf->b_u_memused > (long_u)p_umm * 1024)
+	    u_spill(curbuf);
+
 	if (uhp == NULL)		/* no undo at all */
 	{
 	    if (old_curhead != NULL)
@@ -645,6 +662,15 @@ u_savecommon(
 
 	/* find line number for ue_bot for previous u_save() */
 	u_getbot();
+
+	/* When the lines are just below the lines saved last, e.g. for ":s"
+	 * on a range, add them to that entry. */
+	if (newbot == bot && u_extend_entry(top, bot) == OK)
+	{
+	    curbuf->b_u_synced = FALSE;
+	    undo_undoes = FALSE;
+	    return OK;
+	}
     }
 
 #if !defined(UNIX) && !defined(MSWIN)
@@ -707,6 +733,7 @@ u_savecommon(
     }
     else
 	uep->ue_array = NULL;
+    curbuf->b_u_memused += u_entry_memsize(uep);
     uep->ue_next = curbuf->b_u_newhead->uh_entry;
     curbuf->b_u_newhead->uh_entry = uep;
     curbuf->b_u_synced = FALSE;
@@ -729,6 +756,51 @@ nomem:
     return FAIL;
 }
 
+/*
+ * Add the lines between "top" and "bot" to the last saved entry, if they are
+ * below the lines in it and the number of lines did not change since it was
+ * saved.  A few unchanged lines in between are also saved, that takes less
+ * memory than a new entry.
+ * Returns FAIL when a new entry must be made.
+ */
+    static int
+u_extend_entry(linenr_T top, linenr_T bot)
+{
+    u_entry_T	*uep = curbuf->b_u_newhead->uh_entry;
+    undoline_T	*array;
+    linenr_T	lnum;
+    long	size;
+    long	i;
+
+    if (uep == NULL
+	    || uep->ue_array == NULL
+	    || uep == curbuf->b_u_newhead->uh_getbot_entry
+	    || uep->ue_bot != uep->ue_top + uep->ue_size + 1
+	    || top + 1 < uep->ue_bot
+	    || top + 1 - uep->ue_bot > U_EXTEND_GAP)
+	return FAIL;
+
+    size = uep->ue_size + (bot - uep->ue_bot);
+    array = vim_realloc(uep->ue_array, sizeof(undoline_T) * size);
+    if (array == NULL)
+	return FAIL;
+    uep->ue_array = array;
+    for (i = uep->ue_size, lnum = uep->ue_bot; lnum < bot; ++i, ++lnum)
+    {
+	if (u_save_line(&array[i], lnum) == FAIL)
+	{
+	    /* Keep the lines saved so far, save the rest in a new entry. */
+	    uep->ue_size = i;
+	    uep->ue_bot = lnum;
+	    return FAIL;
+	}
+	curbuf->b_u_memused += sizeof(undoline_T) + array[i].ul_len;
+    }
+    uep->ue_size = size;
+    uep->ue_bot = bot;
+    return OK;
+}
+
 #if defined(FEAT_PERSISTENT_UNDO) || defined(PROTO)
 
 # define UF_START_MAGIC	    "Vim\237UnDo\345"  /* magic at start of undofile */
@@ -1265,6 +1337,10 @@ serialize_uhp(bufinfo_T *bi, u_header_T *uhp)
 
     undo_write_bytes(bi, 0, 1);  /* end marker */
 
+    /* Text moved out for 'undomaxmem' has to be read back first. */
+    if (u_load_spilled(bi->bi_buf, uhp) == FAIL)
+	return FAIL;
+
     /* Write all the entries. */
     for (uep = uhp->uh_entry; uep != NULL; uep = uep->ue_next)
     {
@@ -2096,6 +2172,15 @@ u_read_undo(char_u *name, char_u *hash, char_u *orig_name)
     curbuf->b_u_time_cur = seq_time;
     curbuf->b_u_save_nr_last = last_save_nr;
     curbuf->b_u_save_nr_cur = last_save_nr;
+    for (i = 0; i < num_head; ++i)
+	if (uhp_table[i] != NULL)
+	{
+	    u_entry_T	*uep;
+
+	    for (uep = uhp_table[i]->uh_entry; uep != NULL;
+							   uep = uep->ue_next)
+		curbuf->b_u_memused += u_entry_memsize(uep);
+	}
 
     curbuf->b_u_synced = TRUE;
     vim_free(uhp_table);
@@ -2634,6 +2719,13 @@ u_undoredo(int undo)
 #ifdef U_DEBUG
     u_check(FALSE);
 #endif
+    if (u_load_spilled(curbuf, curhead) == FAIL)
+    {
+	unblock_autocmds();
+	emsg(_("E997: Cannot read undo text back from the spill file"));
+	return;
+    }
+
     old_flags = curhead->uh_flags;
     new_flags = (curbuf->b_changed ? UH_CHANGED : 0) +
 	       ((curbuf->b_ml.ml_flags & ML_EMPTY) ? UH_EMPTYBUF : 0);
@@ -2667,6 +2759,9 @@ u_undoredo(int undo)
 	oldsize = bot - top - 1;    /* number of lines before undo */
 	newsize = uep->ue_size;	    /* number of lines after undo */
 
+	/* the saved lines are replaced with the current text below */
+	curbuf->b_u_memused -= u_entry_memsize(uep);
+
 	if (top < newlnum)
 	{
 	    /* If the saved cursor is somewhere in this undo block, move it to
@@ -2720,6 +2815,8 @@ u_undoredo(int undo)
 		while (uep != NULL)
 		{
 		    nuep = uep->ue_next;
+		    if (nuep != NULL)
+			curbuf->b_u_memused -= u_entry_memsize(nuep);
 		    u_freeentry(uep, uep->ue_size);
 		    uep = nuep;
 		}
@@ -2785,6 +2882,7 @@ u_undoredo(int undo)
 	uep->ue_size = oldsize;
 	uep->ue_array = newarray;
 	uep->ue_bot = top + newsize + 1;
+	curbuf->b_u_memused += u_entry_memsize(uep);
 
 	/*
 	 * insert this entry in front of the new entry list
@@ -3393,6 +3491,7 @@ u_freeentries(
     for (uep = uhp->uh_entry; uep != NULL; uep = nuep)
     {
 	nuep = uep->ue_next;
+	buf->b_u_memused -= u_entry_memsize(uep);
 	u_freeentry(uep, uep->ue_size);
     }
 
@@ -3409,8 +3508,9 @@ u_freeentries(
     static void
 u_freeentry(u_entry_T *uep, long n)
 {
-    while (n > 0)
-	vim_free(uep->ue_array[--n].ul_line);
+    if (uep->ue_array != NULL)	/* NULL when the text was spilled */
+	while (n > 0)
+	    vim_free(uep->ue_array[--n].ul_line);
     vim_free((char_u *)uep->ue_array);
 #ifdef U_DEBUG
     uep->ue_magic = 0;
@@ -3418,6 +3518,174 @@ u_freeentry(u_entry_T *uep, long n)
     vim_free((char_u *)uep);
 }
 
+/*
+ * Return the number of bytes of memory used by undo entry "uep", including
+ * the saved lines when they are in memory.
+ */
+    static long_u
+u_entry_memsize(u_entry_T *uep)
+{
+    long_u	size = sizeof(u_entry_T);
+    long	i;
+
+    if (uep->ue_array != NULL)
+	for (i = 0; i < uep->ue_size; ++i)
+	    size += sizeof(undoline_T) + uep->ue_array[i].ul_len;
+    return size;
+}
+
+/*
+ * Move the text of undo entries of buffer "buf" to a temp file, oldest
+ * changes first, until less than 'undomaxmem' is used.  The text is read back
+ * by u_load_spilled() when the change is undone or redone.
+ */
+    static void
+u_spill(buf_T *buf)
+{
+#ifdef FEAT_CRYPT
+    /* Never write the text of an encrypted buffer to a plain file. */
+    if (*buf->b_p_key != NUL)
+	return;
+#endif
+    if (buf->b_u_spill_fd == NULL)
+    {
+	buf->b_u_spill_fname = vim_tempname('u', FALSE);
+	if (buf->b_u_spill_fname == NULL)
+	    return;
+	buf->b_u_spill_fd = mch_fopen((char *)buf->b_u_spill_fname, "w+b");
+	if (buf->b_u_spill_fd == NULL)
+	{
+	    VIM_CLEAR(buf->b_u_spill_fname);
+	    return;
+	}
+    }
+    u_spill_branch(buf, buf->b_u_oldhead);
+}
+
+/*
+ * Spill the entries of header "uhp", the headers after it and their
+ * alternate branches.  Stops when below 'undomaxmem'.
+ */
+    static void
+u_spill_branch(buf_T *buf, u_header_T *uhp)
+{
+    u_entry_T	*uep;
+
+    for ( ; uhp != NULL; uhp = uhp->uh_prev.ptr)
+    {
+	if (uhp->uh_alt_next.ptr != NULL)
+	    u_spill_branch(buf, uhp->uh_alt_next.ptr);	/* recursive */
+
+	/* The newest change may still get entries added, keep it. */
+	if (uhp == buf->b_u_newhead || uhp == buf->b_u_curhead)
+	    continue;
+	for (uep = uhp->uh_entry; uep != NULL; uep = uep->ue_next)
+	{
+	    if (buf->b_u_memused <= (long_u)p_umm * 1024)
+		return;
+	    if (u_spill_entry(buf, uep) == FAIL)
+		return;
+	}
+    }
+}
+
+/*
+ * Append the lines of entry "uep" to the spill file and free them.
+ * Returns FAIL when writing fails, the lines are then kept.
+ */
+    static int
+u_spill_entry(buf_T *buf, u_entry_T *uep)
+{
+    FILE	*fd = buf->b_u_spill_fd;
+    long_u	size;
+    long	i;
+
+    if (uep->ue_array == NULL)	    /* empty or spilled already */
+	return OK;
+    if (vim_fseek(fd, (off_T)0, SEEK_END) != 0)
+	return FAIL;
+    uep->ue_spill_off = vim_ftell(fd);
+    for (i = 0; i < uep->ue_size; ++i)
+    {
+	undoline_T *ul = &uep->ue_array[i];
+
+	if (fwrite(&ul->ul_len, sizeof(colnr_T), 1, fd) != 1
+		|| fwrite(ul->ul_line, (size_t)ul->ul_len, 1, fd) != 1)
+	    return FAIL;
+    }
+
+    size = u_entry_memsize(uep);
+    for (i = 0; i < uep->ue_size; ++i)
+	vim_free(uep->ue_array[i].ul_line);
+    VIM_CLEAR(uep->ue_array);
+    buf->b_u_memused -= size - u_entry_memsize(uep);
+    return OK;
+}
+
+/*
+ * Read back the text of the entries of header "uhp" that was moved to the
+ * spill file for 'undomaxmem'.
+ * Returns FAIL when reading fails.
+ */
+    static int
+u_load_spilled(buf_T *buf, u_header_T *uhp)
+{
+    FILE	*fd = buf->b_u_spill_fd;
+    u_entry_T	*uep;
+    undoline_T	*array;
+    colnr_T	len;
+    long	i;
+
+    for (uep = uhp->uh_entry; uep != NULL; uep = uep->ue_next)
+    {
+	if (uep->ue_array != NULL || uep->ue_size == 0)
+	    continue;
+	if (fd == NULL || vim_fseek(fd, uep->ue_spill_off, SEEK_SET) != 0)
+	    return FAIL;
+	array = U_ALLOC_LINE(sizeof(undoline_T) * uep->ue_size);
+	if (array == NULL)
+	    return FAIL;
+	for (i = 0; i < uep->ue_size; ++i)
+	{
+	    if (fread(&len, sizeof(colnr_T), 1, fd) != 1 || len <= 0
+			       || (array[i].ul_line = alloc((size_t)len)) == NULL)
+		break;
+	    array[i].ul_len = len;
+	    if (fread(array[i].ul_line, (size_t)len, 1, fd) != 1)
+	    {
+		vim_free(array[i].ul_line);
+		break;
+	    }
+	}
+	if (i < uep->ue_size)
+	{
+	    while (i > 0)
+		vim_free(array[--i].ul_line);
+	    vim_free(array);
+	    return FAIL;
+	}
+	buf->b_u_memused -= u_entry_memsize(uep);
+	uep->ue_array = array;
+	buf->b_u_memused += u_entry_memsize(uep);
+    }
+    return OK;
+}
+
+/*
+ * Close and delete the spill file of buffer "buf", if there is one.
+ */
+    static void
+u_spill_close(buf_T *buf)
+{
+    if (buf->b_u_spill_fd != NULL)
+    {
+	fclose(buf->b_u_spill_fd);
+	buf->b_u_spill_fd = NULL;
+	mch_remove(buf->b_u_spill_fname);
+	VIM_CLEAR(buf->b_u_spill_fname);
+    }
+}
+
 /*
  * invalidate the undo buffer; called when storage has already been released
  */
@@ -3519,6 +3787,8 @@ u_blockfree(buf_T *buf)
     while (buf->b_u_oldhead != NULL)
 	u_freeheader(buf, buf->b_u_oldhead, NULL);
     vim_free(buf->b_u_line_ptr.ul_line);
+    buf->b_u_memused = 0;
+    u_spill_close(buf);
 }
 
 /*
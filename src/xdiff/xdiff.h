@@ -69,6 +69,12 @@ extern "C" {
 typedef struct s_mmfile {
 	char *ptr;
 	long size;
+	/*
+	 * When not NULL: hash of each line, as computed by xdl_hash_record().
+	 * Entries that are zero are computed and stored, so that the caller
+	 * can keep them for a following diff of mostly the same text.
+	 */
+	unsigned long *ha;
 } mmfile_t;
 
 typedef struct s_mmbuffer {
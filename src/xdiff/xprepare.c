@@ -195,7 +195,15 @@ static int xdl_prepare_ctx(unsigned int pass, mmfile_t *mf, long narec, xpparam_
 	if ((cur = blk = xdl_mmfile_first(mf, &bsize)) != NULL) {
 		for (top = blk + bsize; cur < top; ) {
 			prev = cur;
-			hav = xdl_hash_record(&cur, top, xpp->flags);
+			if (mf->ha != NULL && mf->ha[nrec] != 0) {
+				hav = mf->ha[nrec];
+				cur = (char const *) memchr(cur, '\n', top - cur);
+				cur = cur != NULL ? cur + 1 : top;
+			} else {
+				hav = xdl_hash_record(&cur, top, xpp->flags);
+				if (mf->ha != NULL)
+					mf->ha[nrec] = hav;
+			}
 			if (nrec >= narec) {
 				narec *= 2;
 				if (!(rrecs = (xrecord_t **) xdl_realloc(recs, narec * sizeof(xrecord_t *))))
@@ -407,6 +407,8 @@ int xdl_fall_back_diff(xdfenv_t *diff_env, xpparam_t const *xpp,
 	mmfile_t subfile1, subfile2;
 	xdfenv_t env;
 
+	subfile1.ha = NULL;
+	subfile2.ha = NULL;
 	subfile1.ptr = (char *)diff_env->xdf1.recs[line1 - 1]->ptr;
 	subfile1.size = diff_env->xdf1.recs[line1 + count1 - 2]->ptr +
 		diff_env->xdf1.recs[line1 + count1 - 2]->size - subfile1.ptr;